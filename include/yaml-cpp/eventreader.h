@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <ios>
+#include <memory>
+
+#include "yaml-cpp/anchor.h"
+#include "yaml-cpp/dll.h"
+#include "yaml-cpp/emitterstyle.h"
+#include "yaml-cpp/mark.h"
+#include "yaml-cpp/noncopyable.h"
+#include "yaml-cpp/parseoptions.h"
+#include "yaml-cpp/parser.h"
+#include "yaml-cpp/vieweventhandler.h"
+
+namespace YAML {
+class SingleDocParser;
+
+/**
+ * One of the events that a {@link ViewEventHandler} would be called with.
+ * Only the fields that the callback takes are set; the tag and value point
+ * into the reader, and are only valid until it is next moved.
+ */
+struct Event {
+  enum TYPE : char {
+    DOCUMENT_START,
+    DOCUMENT_END,
+    NULL_VALUE,
+    ALIAS,
+    SCALAR,
+    SEQUENCE_START,
+    SEQUENCE_END,
+    MAP_START,
+    MAP_END
+  };
+
+  TYPE type;
+  Mark mark;
+  anchor_t anchor;
+  StringView tag;
+  StringView value;
+  EmitterStyle::value style;
+};
+
+/**
+ * Reads a stream of YAML documents an event at a time, on request, instead
+ * of calling a handler for every event. Nothing is parsed ahead of the event
+ * asked for, so a reader can stop as soon as it has found what it wants.
+ */
+class YAML_CPP_API EventReader : private noncopyable {
+ public:
+  /**
+   * Constructs a reader from the given input, which must live as long as
+   * the reader.
+   */
+  explicit EventReader(std::istream& in);
+  EventReader(std::istream& in, const ParseOptions& options);
+  EventReader(const char* in, std::size_t size);
+  EventReader(const char* in, std::size_t size, const ParseOptions& options);
+
+  ~EventReader();
+
+  /**
+   * Reads the next event into {@code event}.
+   *
+   * @throw a ParserException on error.
+   * @return false, leaving {@code event} alone, at the end of the stream
+   */
+  bool Next(Event& event);
+
+  /**
+   * Skips the node (or the document) that {@link Next} would start to read,
+   * along with all of its children, without handing over any of its events;
+   * anchors within it are still kept track of. Does nothing if the next
+   * event ends a collection or a document, or if there are none left.
+   *
+   * @throw a ParserException on error.
+   */
+  void SkipValue();
+
+ private:
+  class Queue;
+
+  // Makes sure that the next event is in the queue.
+  bool Fill();
+
+ private:
+  Parser m_parser;
+  std::unique_ptr<SingleDocParser> m_pDocument;
+  std::unique_ptr<Queue> m_pQueue;
+};
+}
@@ -128,6 +128,10 @@ class YAML_CPP_API Exception : public std::runtime_error {
     }
 
     std::stringstream output;
+    if (mark.is_offset_only()) {
+      output << "yaml-cpp: error at byte " << mark.pos << ": " << msg;
+      return output.str();
+    }
     output << "yaml-cpp: error at line " << mark.line + 1 << ", column "
            << mark.column + 1 << ": " << msg;
     return output.str();
@@ -8,7 +8,12 @@ struct YAML_CPP_API Mark {
 
   static const Mark null_mark() { return Mark(-1, -1, -1); }
 
+  // A mark that knows only its byte offset into the input, as reported when
+  // marks aren't tracked (see ParseOptions::trackMarks).
+  static const Mark offset_mark(int pos_) { return Mark(pos_, -1, -1); }
+
   bool is_null() const { return pos == -1 && line == -1 && column == -1; }
+  bool is_offset_only() const { return pos != -1 && line == -1; }
 
   int pos;
   int line, column;
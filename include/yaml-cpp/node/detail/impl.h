@@ -241,7 +241,10 @@ inline void node_data::force_insert(const Key& key, const Value& value,
 
 template <typename T>
 inline node& node_data::convert_to_node(const T& rhs, shared_memory& pMemory) {
-  return *Node(rhs, pMemory).m_pNode;
+  Node value(rhs, pMemory);
+  // a Node is taken as it is, along with the memory that holds it
+  pMemory->merge(*value.m_pMemory);
+  return *value.m_pNode;
 }
 }
 }
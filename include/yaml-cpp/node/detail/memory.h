@@ -2,14 +2,19 @@
 
 #include <list>
 #include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "yaml-cpp/dll.h"
+#include "yaml-cpp/mark.h"
 #include "yaml-cpp/node/ptr.h"
 
 namespace YAML {
 namespace detail {
 class node;
 struct node_bucket;
+struct mark_lines;
 }  // namespace detail
 }  // namespace YAML
 
@@ -21,11 +26,26 @@ class YAML_CPP_API memory : public ref_counted {
   node& create_node();
   void merge(memory& rhs);
 
+  // A node keeps only the byte offset of its mark, and a table here of the
+  // line starts seen in the marks set so far, which turns the offset back
+  // into a line and a column. The tables move with the nodes on a merge.
+  void set_mark(node& node, const Mark& mark);
+
+  // Returns the copy of {@code tag} that nodes tagged here share, so a
+  // document stores each of its tags once. Tags merged in from another
+  // memory keep their own copies. It lives as long as this memory, or the
+  // one it is merged into.
+  const std::string& intern_tag(const std::string& tag);
+
   memory();
   ~memory();
 
  private:
   std::unique_ptr<node_bucket> buckets;
+  std::vector<std::unique_ptr<mark_lines>> lines;
+  mark_lines* current_lines;  // for marks set here, rather than merged in
+  std::unordered_set<std::string> tags;
+  std::list<std::unordered_set<std::string>> merged_tags;
 };
 
 struct memory_ref : ref_counted {
@@ -36,6 +56,10 @@ struct memory_ref : ref_counted {
   ~memory_ref() {}
 
   node& create_node() { return m_ptr->create_node(); }
+  void set_mark(node& node, const Mark& mark) { m_ptr->set_mark(node, mark); }
+  const std::string& intern_tag(const std::string& tag) {
+    return m_ptr->intern_tag(tag);
+  }
 
   void merge(memory_ref& rhs) {
     if (m_ptr == rhs.m_ptr) {
@@ -22,16 +22,13 @@ class node {
   ~node() {}
 
   node(const node&) = delete;
-  // required for bucket reserve
-  node(node&&) = default;
   node& operator=(const node&) = delete;
-  node& operator=(node&&) = default;
 
   bool is(const node& rhs) const { return m_pRef == rhs.m_pRef; }
   const node_data* ref() const { return m_pRef.get(); }
 
   bool is_defined() const { return m_pRef->is_defined(); }
-  const Mark& mark() const { return m_pRef->mark(); }
+  Mark mark() const { return m_pRef->mark(); }
   NodeType::value type() const { return m_pRef->type(); }
 
   const std::string& scalar() const { return static_cast<const node_data&>(*m_pRef).scalar(); }
@@ -51,7 +48,9 @@ class node {
     }
   }
 
-  void set_mark(const Mark& mark) { m_pRef->set_mark(mark); }
+  void set_mark(int pos, const mark_lines* lines) {
+    m_pRef->set_mark(pos, lines);
+  }
 
   void set_type(NodeType::value type) {
     if (type != NodeType::Undefined)
@@ -70,9 +69,9 @@ class node {
     if (!is_defined()) mark_defined();
     m_pRef->set_scalar(std::move(scalar));
   }
-  void set_tag(const std::string& tag) {
+  void set_tag(const std::string& tag, shared_memory& pMemory) {
     if (!is_defined()) mark_defined();
-    m_pRef->set_tag(tag);
+    m_pRef->set_tag(tag, pMemory);
   }
 
   // style
@@ -8,6 +8,7 @@
 #include <cassert>
 
 #include "yaml-cpp/dll.h"
+#include "yaml-cpp/mark.h"
 #include "yaml-cpp/node/detail/node_iterator.h"
 #include "yaml-cpp/node/detail/string_view.h"
 #include "yaml-cpp/node/iterator.h"
@@ -17,7 +18,7 @@
 namespace YAML {
 namespace detail {
 class node;
-
+struct mark_lines;
 }  // namespace detail
 }  // namespace YAML
 
@@ -48,16 +49,20 @@ class YAML_CPP_API node_data : public ref_counted {
 
   void mark_defined();
   void set_type(NodeType::value type);
-  void set_tag(const std::string& tag);
+  void set_tag(const std::string& tag, shared_memory& pMemory);
   void set_null();
   void set_scalar(const std::string& scalar);
   void set_scalar(std::string&& scalar);
 
-  void set_mark(const Mark& mark) { m_mark = mark; }
+  // see memory::set_mark
+  void set_mark(int pos, const mark_lines* lines) {
+    m_markPos = pos;
+    m_markLines = lines;
+  }
   void set_style(EmitterStyle::value style) { m_style = style; }
 
   bool is_defined() const { return m_type != NodeType::Undefined; }
-  const Mark& mark() const { return m_mark; }
+  Mark mark() const;
   NodeType::value type() const {
     return m_type;
   }
@@ -170,7 +175,8 @@ class YAML_CPP_API node_data : public ref_counted {
   EmitterStyle::value m_style;
   mutable bool m_hasUndefined;
 
-  Mark m_mark;
+  int m_markPos;
+  const mark_lines* m_markLines;
 
   using data = typename std::aligned_storage<
     static_max<sizeof(std::string),
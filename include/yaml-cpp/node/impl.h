@@ -183,7 +183,7 @@ inline const std::string& Node::Tag() const {
 inline void Node::SetTag(const std::string& tag) {
   ThrowOnInvalid();
   EnsureNodeExists();
-  m_pNode->set_tag(tag);
+  m_pNode->set_tag(tag, m_pMemory);
 }
 
 inline EmitterStyle::value Node::Style() const {
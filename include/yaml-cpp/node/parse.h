@@ -1,13 +1,19 @@
 #pragma once
 
+#include <cstddef>
 #include <iosfwd>
 #include <string>
 #include <vector>
 
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
 #include "yaml-cpp/dll.h"
 
 namespace YAML {
 class Node;
+struct ParseOptions;
 
 /**
  * Loads the input string as a single YAML document.
@@ -23,6 +29,23 @@ YAML_CPP_API Node Load(const std::string& input);
  */
 YAML_CPP_API Node Load(const char* input);
 
+/**
+ * Loads the first {@code size} bytes at {@code input} as a single YAML
+ * document. The buffer is parsed in place, without copying it.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+YAML_CPP_API Node Load(const char* input, std::size_t size);
+
+/**
+ * Loads the first {@code size} bytes at {@code input} as a single YAML
+ * document, in place, reading it as set up by {@code options}.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+YAML_CPP_API Node Load(const char* input, std::size_t size,
+                       const ParseOptions& options);
+
 /**
  * Loads the input stream as a single YAML document.
  *
@@ -30,6 +53,14 @@ YAML_CPP_API Node Load(const char* input);
  */
 YAML_CPP_API Node Load(std::istream& input);
 
+/**
+ * Loads the input stream as a single YAML document, reading it as set up by
+ * {@code options}.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+YAML_CPP_API Node Load(std::istream& input, const ParseOptions& options);
+
 /**
  * Loads the input file as a single YAML document.
  *
@@ -38,6 +69,16 @@ YAML_CPP_API Node Load(std::istream& input);
  */
 YAML_CPP_API Node LoadFile(const std::string& filename);
 
+/**
+ * Loads the input file as a single YAML document, reading it as set up by
+ * {@code options}.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ * @throws {@link BadFile} if the file cannot be loaded.
+ */
+YAML_CPP_API Node LoadFile(const std::string& filename,
+                           const ParseOptions& options);
+
 /**
  * Loads the input string as a list of YAML documents.
  *
@@ -52,6 +93,23 @@ YAML_CPP_API std::vector<Node> LoadAll(const std::string& input);
  */
 YAML_CPP_API std::vector<Node> LoadAll(const char* input);
 
+/**
+ * Loads the first {@code size} bytes at {@code input} as a list of YAML
+ * documents. The buffer is parsed in place, without copying it.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+YAML_CPP_API std::vector<Node> LoadAll(const char* input, std::size_t size);
+
+/**
+ * Loads the first {@code size} bytes at {@code input} as a list of YAML
+ * documents, in place, reading them as set up by {@code options}.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+YAML_CPP_API std::vector<Node> LoadAll(const char* input, std::size_t size,
+                                       const ParseOptions& options);
+
 /**
  * Loads the input stream as a list of YAML documents.
  *
@@ -59,6 +117,15 @@ YAML_CPP_API std::vector<Node> LoadAll(const char* input);
  */
 YAML_CPP_API std::vector<Node> LoadAll(std::istream& input);
 
+/**
+ * Loads the input stream as a list of YAML documents, reading it as set up by
+ * {@code options}.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+YAML_CPP_API std::vector<Node> LoadAll(std::istream& input,
+                                       const ParseOptions& options);
+
 /**
  * Loads the input file as a list of YAML documents.
  *
@@ -66,4 +133,34 @@ YAML_CPP_API std::vector<Node> LoadAll(std::istream& input);
  * @throws {@link BadFile} if the file cannot be loaded.
  */
 YAML_CPP_API std::vector<Node> LoadAllFromFile(const std::string& filename);
+
+/**
+ * Loads the input file as a list of YAML documents, reading it as set up by
+ * {@code options}.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ * @throws {@link BadFile} if the file cannot be loaded.
+ */
+YAML_CPP_API std::vector<Node> LoadAllFromFile(const std::string& filename,
+                                               const ParseOptions& options);
+
+#if __cplusplus >= 201703L
+/**
+ * Loads the viewed string as a single YAML document, without copying it.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+inline Node Load(std::string_view input) {
+  return Load(input.data(), input.size());
+}
+
+/**
+ * Loads the viewed string as a list of YAML documents, without copying it.
+ *
+ * @throws {@link ParserException} if it is malformed.
+ */
+inline std::vector<Node> LoadAll(std::string_view input) {
+  return LoadAll(input.data(), input.size());
+}
+#endif
 }  // namespace YAML
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+#include "yaml-cpp/dll.h"
+
+namespace YAML {
+/**
+ * Opt-in settings for a {@link Parser}. The defaults match the behaviour of
+ * a parser constructed without options.
+ */
+struct YAML_CPP_API ParseOptions {
+  ParseOptions()
+      : backgroundReadAhead(false),
+        repairUtf8(false),
+        trackMarks(true),
+        threads(1) {}
+
+  /**
+   * When reading from an std::istream, fill the input buffers on a helper
+   * thread a few blocks ahead of the parser, so that slow input (a disk, a
+   * pipe from a decompressor) overlaps with scanning. The stream must not be
+   * touched by anyone else while the parser is alive.
+   */
+  bool backgroundReadAhead;
+
+  /**
+   * Ill-formed UTF-8 normally passes through to the parsed scalars as it is.
+   * Set this to check UTF-8 input up front and replace each ill-formed
+   * sequence with U+FFFD, as malformed UTF-16 and UTF-32 input already is.
+   * Input that passes the check is still read without a copy.
+   */
+  bool repairUtf8;
+
+  /**
+   * Clear this to stop counting lines for a buffer that holds one JSON object
+   * or array, for input whose positions will never be shown. Its events and
+   * nodes then get marks holding only the byte offset (see
+   * Mark::offset_mark), and it is never scanned for line breaks. YAML input
+   * always gets full marks: the scanner needs lines and columns to read
+   * simple keys and indentation, so reporting them costs nothing more.
+   */
+  bool trackMarks;
+
+  /**
+   * The number of threads that LoadAll and LoadAllFromFile may use to load
+   * the documents of a buffer or a file side by side, or 0 for one per
+   * hardware thread. The documents come back in order, as they would from
+   * one thread. Load and LoadFile likewise split a document whose root is a
+   * block sequence or mapping between the entries that start a line; if the
+   * pieces don't read as entries of the root, the document is read again on
+   * one thread. Input read from an std::istream, input with directives and
+   * input that isn't UTF-8 are always loaded on one thread.
+   */
+  unsigned threads;
+};
+
+/**
+ * Counters describing how a {@link Parser} was fed from an std::istream.
+ * Without background read-ahead, every block is read on the parsing thread,
+ * so every block counts as a stall.
+ */
+struct YAML_CPP_API InputStats {
+  InputStats()
+      : bytesRead(0), blocksRead(0), stalls(0), stallNanoseconds(0) {}
+
+  std::uint64_t bytesRead;
+  std::uint64_t blocksRead;
+
+  /** The number of times the parser had to wait for input. */
+  std::uint64_t stalls;
+
+  /** The total time the parser spent waiting for input. */
+  std::uint64_t stallNanoseconds;
+};
+}
@@ -1,15 +1,21 @@
 #pragma once
 
+#include <cstddef>
 #include <ios>
 #include <memory>
+#include <string>
 
 #include "yaml-cpp/dll.h"
+#include "yaml-cpp/mark.h"
 #include "yaml-cpp/noncopyable.h"
+#include "yaml-cpp/parseoptions.h"
 
 namespace YAML {
 class EventHandler;
+class EventReader;
 class Node;
 class Scanner;
+class ViewEventHandler;
 struct Directives;
 struct Token;
 
@@ -18,6 +24,8 @@ struct Token;
  * document in the input stream.
  */
 class YAML_CPP_API Parser : private noncopyable {
+  friend class EventReader;
+
  public:
   /** Constructs an empty parser (with no input. */
   Parser();
@@ -27,8 +35,24 @@ class YAML_CPP_API Parser : private noncopyable {
    * live as long as the parser.
    */
   explicit Parser(std::istream& in);
+  Parser(std::istream& in, const ParseOptions& options);
   explicit Parser(const std::string& in);
 
+  /**
+   * Constructs a parser that reads directly from the given buffer, without
+   * copying it. The buffer must live as long as the parser.
+   */
+  Parser(const char* in, std::size_t size);
+  Parser(const char* in, std::size_t size, const ParseOptions& options);
+
+  /**
+   * Constructs a parser for a piece of a larger buffer, which starts at
+   * {@code start} (the beginning of a line), so that marks are positions in
+   * the whole buffer.
+   */
+  Parser(const char* in, std::size_t size, const ParseOptions& options,
+         const Mark& start);
+
   ~Parser();
 
   /** Evaluates to true if the parser has some valid input to be read. */
@@ -39,7 +63,12 @@ class YAML_CPP_API Parser : private noncopyable {
    * erased.
    */
   void Load(std::istream& in);
+  void Load(std::istream& in, const ParseOptions& options);
   void Load(const std::string& in);
+  void Load(const char* in, std::size_t size);
+  void Load(const char* in, std::size_t size, const ParseOptions& options);
+  void Load(const char* in, std::size_t size, const ParseOptions& options,
+            const Mark& start);
 
   /**
    * Handles the next document by calling events on the {@code eventHandler}.
@@ -49,6 +78,23 @@ class YAML_CPP_API Parser : private noncopyable {
    */
   bool HandleNextDocument(EventHandler& eventHandler);
 
+  /**
+   * Handles the next document like the overload above, but hands scalars
+   * and tags to the {@code eventHandler} as views instead of strings. The
+   * views point into the input where they can (into the parser's own copy
+   * of a scalar otherwise), and are only valid during the callback.
+   *
+   * @throw a ParserException on error.
+   * @return false if there are no more documents
+   */
+  bool HandleNextDocument(ViewEventHandler& eventHandler);
+
+  /**
+   * Returns how the current input stream has been read so far; all counters
+   * are zero unless the parser reads from an std::istream.
+   */
+  InputStats GetInputStats() const;
+
   void PrintTokens(std::ostream& out);
 
  private:
@@ -72,8 +118,31 @@ class YAML_CPP_API Parser : private noncopyable {
    */
   void HandleTagDirective(const Token& token);
 
+  /**
+   * Reads any directives ahead of the next document.
+   *
+   * @return false if there are no more documents
+   */
+  bool PrepareNextDocument();
+
+  /** The body of HandleNextDocument, for either kind of handler. */
+  template <typename Handler>
+  bool HandleDocument(Handler& eventHandler);
+
+  /**
+   * Handles the whole input as a single JSON document, without going through
+   * the scanner, if it is one and the input is a contiguous buffer.
+   *
+   * @return false, having handled nothing, otherwise
+   */
+  template <typename Handler>
+  bool HandleJsonDocument(Handler& eventHandler);
+
  private:
   std::unique_ptr<Scanner> m_pScanner;
   std::unique_ptr<Directives> m_pDirectives;
+
+  // see ParseOptions::trackMarks; only the JSON path heeds it
+  bool m_trackMarks = true;
 };
 }
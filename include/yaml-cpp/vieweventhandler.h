@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#include "yaml-cpp/anchor.h"
+#include "yaml-cpp/emitterstyle.h"
+
+namespace YAML {
+struct Mark;
+
+/**
+ * Characters that belong to the parser, such as a scalar or a tag. They are
+ * only valid during the callback they are passed to; copy them to keep them.
+ */
+struct StringView {
+  const char* data;
+  std::size_t size;
+
+  std::string str() const { return std::string(data, size); }
+
+  bool operator==(const std::string& rhs) const {
+    return rhs.size() == size && rhs.compare(0, size, data, size) == 0;
+  }
+  bool operator!=(const std::string& rhs) const { return !(*this == rhs); }
+
+#if __cplusplus >= 201703L
+  operator std::string_view() const { return std::string_view(data, size); }
+#endif
+};
+
+inline bool operator==(const std::string& lhs, const StringView& rhs) {
+  return rhs == lhs;
+}
+inline bool operator!=(const std::string& lhs, const StringView& rhs) {
+  return rhs != lhs;
+}
+
+/**
+ * Receives the same events as an {@link EventHandler}, but the scalars and
+ * tags are handed over as views into the parser's own memory, so none are
+ * copied into strings for handlers that only look at them.
+ */
+class ViewEventHandler {
+ public:
+  virtual ~ViewEventHandler() {}
+
+  virtual void OnDocumentStart(const Mark& mark) = 0;
+  virtual void OnDocumentEnd() = 0;
+
+  virtual void OnNull(const Mark& mark, anchor_t anchor) = 0;
+  virtual void OnAlias(const Mark& mark, anchor_t anchor) = 0;
+  virtual void OnScalar(const Mark& mark, StringView tag, anchor_t anchor,
+                        StringView value) = 0;
+
+  virtual void OnSequenceStart(const Mark& mark, StringView tag,
+                               anchor_t anchor, EmitterStyle::value style) = 0;
+  virtual void OnSequenceEnd() = 0;
+
+  virtual void OnMapStart(const Mark& mark, StringView tag, anchor_t anchor,
+                          EmitterStyle::value style) = 0;
+  virtual void OnMapEnd() = 0;
+};
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "yaml-cpp/parser.h"
+#include "yaml-cpp/eventreader.h"
+#include "yaml-cpp/parseoptions.h"
 #include "yaml-cpp/emitter.h"
 #include "yaml-cpp/emitterstyle.h"
 #include "yaml-cpp/stlemitter.h"
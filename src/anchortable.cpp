@@ -0,0 +1,92 @@
+#include "anchortable.h"
+
+#include <cstring>
+
+namespace YAML {
+namespace {
+const std::size_t InitialSlots = 16;
+const std::size_t BlockSize = 4096;
+}  // namespace
+
+AnchorTable::AnchorTable()
+    : m_slots(), m_count(0), m_blocks(), m_blockNext(nullptr), m_blockLeft(0) {}
+
+AnchorTable::~AnchorTable() {}
+
+void AnchorTable::Set(const char* name, std::size_t size, anchor_t anchor) {
+  if ((m_count + 1) * 2 > m_slots.size()) {
+    Grow();
+  }
+
+  const std::size_t hash = Hash(name, size);
+  Slot& slot = m_slots[Probe(name, size, hash)];
+  if (!slot.name) {
+    slot.name = Intern(name, size);
+    slot.size = size;
+    slot.hash = hash;
+    m_count++;
+  }
+  slot.anchor = anchor;
+}
+
+anchor_t AnchorTable::Find(const char* name, std::size_t size) const {
+  if (m_count == 0) {
+    return NullAnchor;
+  }
+  return m_slots[Probe(name, size, Hash(name, size))].anchor;
+}
+
+std::size_t AnchorTable::Hash(const char* name, std::size_t size) {
+  // FNV-1a; anchor names are short
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < size; i++) {
+    hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ULL;
+  }
+  return static_cast<std::size_t>(hash ^ (hash >> 32));
+}
+
+std::size_t AnchorTable::Probe(const char* name, std::size_t size,
+                               std::size_t hash) const {
+  const std::size_t mask = m_slots.size() - 1;
+  for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+    const Slot& slot = m_slots[i];
+    if (!slot.name ||
+        (slot.hash == hash && slot.size == size &&
+         std::memcmp(slot.name, name, size) == 0)) {
+      return i;
+    }
+  }
+}
+
+void AnchorTable::Grow() {
+  std::vector<Slot> slots(m_slots.empty() ? InitialSlots : m_slots.size() * 2,
+                          Slot{nullptr, 0, 0, NullAnchor});
+  slots.swap(m_slots);
+
+  const std::size_t mask = m_slots.size() - 1;
+  for (const Slot& slot : slots) {
+    if (slot.name) {
+      std::size_t i = slot.hash & mask;
+      while (m_slots[i].name) {
+        i = (i + 1) & mask;
+      }
+      m_slots[i] = slot;
+    }
+  }
+}
+
+const char* AnchorTable::Intern(const char* name, std::size_t size) {
+  if (size > m_blockLeft || !m_blockNext) {
+    const std::size_t blockSize = size > BlockSize ? size : BlockSize;
+    m_blocks.emplace_back(new char[blockSize]);
+    m_blockNext = m_blocks.back().get();
+    m_blockLeft = blockSize;
+  }
+
+  char* interned = m_blockNext;
+  std::memcpy(interned, name, size);
+  m_blockNext += size;
+  m_blockLeft -= size;
+  return interned;
+}
+}
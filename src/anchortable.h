@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "yaml-cpp/anchor.h"
+#include "yaml-cpp/noncopyable.h"
+
+namespace YAML {
+/**
+ * Maps anchor names to the ids they were registered under, by open
+ * addressing on a hash of the name. The names are copied into blocks owned
+ * by the table, so a lookup can be made with any run of characters (such as
+ * a token that refers to the input) without building a string first.
+ */
+class AnchorTable : private noncopyable {
+ public:
+  AnchorTable();
+  ~AnchorTable();
+
+  /** Maps {@code name} to {@code anchor}, replacing any earlier mapping. */
+  void Set(const char* name, std::size_t size, anchor_t anchor);
+
+  /** Returns the anchor that {@code name} maps to, or NullAnchor. */
+  anchor_t Find(const char* name, std::size_t size) const;
+
+ private:
+  struct Slot {
+    const char* name;
+    std::size_t size;
+    std::size_t hash;
+    anchor_t anchor;
+  };
+
+  static std::size_t Hash(const char* name, std::size_t size);
+
+  // Returns the index of the slot holding {@code name}, or of the empty slot
+  // it would go in.
+  std::size_t Probe(const char* name, std::size_t size,
+                    std::size_t hash) const;
+
+  void Grow();
+  const char* Intern(const char* name, std::size_t size);
+
+ private:
+  std::vector<Slot> m_slots;  // a power of two in size, at most half full
+  std::size_t m_count;
+
+  std::vector<std::unique_ptr<char[]>> m_blocks;
+  char* m_blockNext;
+  std::size_t m_blockLeft;
+};
+}
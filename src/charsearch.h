@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace YAML {
+/**
+ * Searches for (or skips over) a small, fixed set of characters, 32 or 16
+ * bytes per step where the target supports it.
+ */
+namespace CharSearch {
+namespace detail {
+template <char... Cs>
+struct Set;
+
+template <>
+struct Set<> {
+  static bool Contains(char) { return false; }
+#if defined(__SSE2__)
+  static __m128i Match(__m128i) { return _mm_setzero_si128(); }
+#endif
+#if defined(__AVX2__)
+  static __m256i Match(__m256i) { return _mm256_setzero_si256(); }
+#endif
+};
+
+template <char C, char... Cs>
+struct Set<C, Cs...> {
+  static bool Contains(char ch) { return ch == C || Set<Cs...>::Contains(ch); }
+#if defined(__SSE2__)
+  static __m128i Match(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(C)),
+                        Set<Cs...>::Match(v));
+  }
+#endif
+#if defined(__AVX2__)
+  static __m256i Match(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(C)),
+                           Set<Cs...>::Match(v));
+  }
+#endif
+};
+
+// Returns the first position in [begin, end) where the character's
+// membership in Cs equals Member, or end.
+template <bool Member, char... Cs>
+inline const char* Find(const char* begin, const char* end) {
+#if defined(__AVX2__)
+  for (; end - begin >= 32; begin += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    unsigned mask =
+        static_cast<unsigned>(_mm256_movemask_epi8(Set<Cs...>::Match(v)));
+    if (!Member) {
+      mask = ~mask;
+    }
+    if (mask) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  for (; end - begin >= 16; begin += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    unsigned mask =
+        static_cast<unsigned>(_mm_movemask_epi8(Set<Cs...>::Match(v)));
+    if (!Member) {
+      mask = ~mask & 0xFFFF;
+    }
+    if (mask) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+#endif
+  while (begin != end && Set<Cs...>::Contains(*begin) != Member) {
+    ++begin;
+  }
+  return begin;
+}
+}  // namespace detail
+
+/** Returns the first position in [begin, end) holding one of Cs, or end. */
+template <char... Cs>
+inline const char* FindAny(const char* begin, const char* end) {
+  return detail::Find<true, Cs...>(begin, end);
+}
+
+/** Returns the first position in [begin, end) holding none of Cs, or end. */
+template <char... Cs>
+inline const char* SkipAny(const char* begin, const char* end) {
+  return detail::Find<false, Cs...>(begin, end);
+}
+}
+}
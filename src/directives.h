@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 
 namespace YAML {
 struct Version {
@@ -16,5 +17,10 @@ struct Directives {
 
   Version version;
   std::map<std::string, std::string> tags;
+
+  // full tags by suffix, for each handle (as written) that Tag::Translate
+  // has seen; neither map moves its entries, so they can be handed out
+  typedef std::unordered_map<std::string, std::string> TranslatedTags;
+  mutable std::map<std::string, TranslatedTags> translatedTags;
 };
 }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+namespace YAML {
+/**
+ * Returns true if the line at {@code line}, of {@code length} bytes ending
+ * at {@code newline} (null for the last line of the input), is the document
+ * marker {@code marker} ("---" or "...") followed by a blank or a break.
+ * Such a line ends any scalar or collection it appears in, so this is all it
+ * takes to tell where documents are.
+ */
+inline bool IsDocumentMarker(const char* line, std::size_t length,
+                             const char* newline, const char* marker) {
+  return length >= 4 &&
+         (line[3] == ' ' || line[3] == '\t' || line[3] == '\n' ||
+          (line[3] == '\r' && newline == line + 4)) &&
+         std::strncmp(line, marker, 3) == 0;
+}
+}
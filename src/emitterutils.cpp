@@ -5,6 +5,7 @@
 #include "exp.h"
 #include "indentation.h"
 #include "stringsource.h"
+#include "utf8.h"
 #include "yaml-cpp/binary.h"  // IWYU pragma: keep
 #include "yaml-cpp/ostream_wrapper.h"
 #include "yaml-cpp/null.h"
@@ -128,6 +129,27 @@ bool GetNextCodePointAndAdvance(int& codePoint,
   return true;
 }
 
+// Well-formed UTF-8 without noncharacters comes out of
+// GetNextCodePointAndAdvance and WriteCodePoint unchanged, so such strings
+// can be copied a run at a time instead of a code point at a time.
+bool IsVerbatimUtf8(const std::string& str) {
+  return Utf8::IsValid(str.data(), str.size(), Utf8::RejectNoncharacters);
+}
+
+// Writes str up to the next of the given characters (or its end) and returns
+// the position of that character.
+std::size_t WriteUntil(ostream_wrapper& out, const std::string& str,
+                       std::size_t pos, const char* stops) {
+  std::size_t next = str.find_first_of(stops, pos);
+  std::size_t end = next == std::string::npos ? str.size() : next;
+  out.write(str.data() + pos, end - pos);
+  return next;
+}
+
+bool IsUnescapedAscii(char ch) {
+  return ch >= 0x20 && ch <= 0x7E && ch != '"' && ch != '\\';
+}
+
 void WriteCodePoint(ostream_wrapper& out, int codePoint) {
   if (codePoint < 0 || codePoint > 0x10FFFF) {
     codePoint = REPLACEMENT_CHARACTER;
@@ -287,6 +309,22 @@ StringFormat::value ComputeStringFormat(const std::string& str,
 
 bool WriteSingleQuotedString(ostream_wrapper& out, const std::string& str) {
   out << "'";
+  if (IsVerbatimUtf8(str)) {
+    for (std::size_t pos = 0;;) {
+      std::size_t next = WriteUntil(out, str, pos, "\n'");
+      if (next == std::string::npos) {
+        break;
+      }
+      if (str[next] == '\n') {
+        return false;
+      }
+      out << "''";
+      pos = next + 1;
+    }
+    out << "'";
+    return true;
+  }
+
   int codePoint;
   for (std::string::const_iterator i = str.begin();
        GetNextCodePointAndAdvance(codePoint, i, str.end());) {
@@ -309,8 +347,20 @@ bool WriteDoubleQuotedString(ostream_wrapper& out, const std::string& str,
                              bool escapeNonAscii) {
   out << "\"";
   int codePoint;
-  for (std::string::const_iterator i = str.begin();
-       GetNextCodePointAndAdvance(codePoint, i, str.end());) {
+  for (std::string::const_iterator i = str.begin();;) {
+    // most text needs no escaping, so copy it a run at a time
+    std::string::const_iterator run = i;
+    while (run != str.end() && IsUnescapedAscii(*run)) {
+      ++run;
+    }
+    if (run != i) {
+      out.write(&*i, run - i);
+      i = run;
+    }
+
+    if (!GetNextCodePointAndAdvance(codePoint, i, str.end())) {
+      break;
+    }
     switch (codePoint) {
       case '\"':
         out << "\\\"";
@@ -353,6 +403,18 @@ bool WriteLiteralString(ostream_wrapper& out, const std::string& str,
                         std::size_t indent) {
   out << "|\n";
   out << IndentTo(indent);
+  if (IsVerbatimUtf8(str)) {
+    for (std::size_t pos = 0;;) {
+      std::size_t next = WriteUntil(out, str, pos, "\n");
+      if (next == std::string::npos) {
+        break;
+      }
+      out << "\n" << IndentTo(indent);
+      pos = next + 1;
+    }
+    return true;
+  }
+
   int codePoint;
   for (std::string::const_iterator i = str.begin();
        GetNextCodePointAndAdvance(codePoint, i, str.end());) {
@@ -393,6 +455,20 @@ bool WriteComment(ostream_wrapper& out, const std::string& str,
   const std::size_t curIndent = out.col();
   out << "#" << Indentation(postCommentIndent);
   out.set_comment();
+  if (IsVerbatimUtf8(str)) {
+    for (std::size_t pos = 0;;) {
+      std::size_t next = WriteUntil(out, str, pos, "\n");
+      if (next == std::string::npos) {
+        break;
+      }
+      out << "\n" << IndentTo(curIndent) << "#"
+          << Indentation(postCommentIndent);
+      out.set_comment();
+      pos = next + 1;
+    }
+    return true;
+  }
+
   int codePoint;
   for (std::string::const_iterator i = str.begin();
        GetNextCodePointAndAdvance(codePoint, i, str.end());) {
@@ -0,0 +1,148 @@
+#include "yaml-cpp/eventreader.h"
+
+#include <vector>
+
+#include "directives.h"  // IWYU pragma: keep
+#include "scanner.h"
+#include "singledocparser.h"
+
+namespace YAML {
+// Holds the events of the last step of the document's parser, until they are
+// read.
+class EventReader::Queue : public ViewEventHandler {
+ public:
+  Queue() : m_events(), m_next(0) {}
+
+  bool empty() const { return m_next == m_events.size(); }
+  const Event& front() const { return m_events[m_next]; }
+  void pop() {
+    if (++m_next == m_events.size()) {
+      m_events.clear();
+      m_next = 0;
+    }
+  }
+
+  void OnDocumentStart(const Mark& mark) override {
+    Push(Event::DOCUMENT_START, mark);
+  }
+  void OnDocumentEnd() override { Push(Event::DOCUMENT_END, Mark()); }
+
+  void OnNull(const Mark& mark, anchor_t anchor) override {
+    Push(Event::NULL_VALUE, mark).anchor = anchor;
+  }
+  void OnAlias(const Mark& mark, anchor_t anchor) override {
+    Push(Event::ALIAS, mark).anchor = anchor;
+  }
+  void OnScalar(const Mark& mark, StringView tag, anchor_t anchor,
+                StringView value) override {
+    Event& event = Push(Event::SCALAR, mark);
+    event.tag = tag;
+    event.anchor = anchor;
+    event.value = value;
+  }
+
+  void OnSequenceStart(const Mark& mark, StringView tag, anchor_t anchor,
+                       EmitterStyle::value style) override {
+    Event& event = Push(Event::SEQUENCE_START, mark);
+    event.tag = tag;
+    event.anchor = anchor;
+    event.style = style;
+  }
+  void OnSequenceEnd() override { Push(Event::SEQUENCE_END, Mark()); }
+
+  void OnMapStart(const Mark& mark, StringView tag, anchor_t anchor,
+                  EmitterStyle::value style) override {
+    Event& event = Push(Event::MAP_START, mark);
+    event.tag = tag;
+    event.anchor = anchor;
+    event.style = style;
+  }
+  void OnMapEnd() override { Push(Event::MAP_END, Mark()); }
+
+ private:
+  Event& Push(Event::TYPE type, const Mark& mark) {
+    Event event;
+    event.type = type;
+    event.mark = mark;
+    event.anchor = NullAnchor;
+    event.tag = StringView{"", 0};
+    event.value = StringView{"", 0};
+    event.style = EmitterStyle::Default;
+    m_events.push_back(event);
+    return m_events.back();
+  }
+
+ private:
+  std::vector<Event> m_events;
+  std::size_t m_next;
+};
+
+EventReader::EventReader(std::istream& in)
+    : m_parser(in), m_pDocument(), m_pQueue(new Queue) {}
+EventReader::EventReader(std::istream& in, const ParseOptions& options)
+    : m_parser(in, options), m_pDocument(), m_pQueue(new Queue) {}
+EventReader::EventReader(const char* in, std::size_t size)
+    : m_parser(in, size), m_pDocument(), m_pQueue(new Queue) {}
+EventReader::EventReader(const char* in, std::size_t size,
+                         const ParseOptions& options)
+    : m_parser(in, size, options), m_pDocument(), m_pQueue(new Queue) {}
+
+EventReader::~EventReader() {}
+
+bool EventReader::Next(Event& event) {
+  if (!Fill()) {
+    return false;
+  }
+
+  event = m_pQueue->front();
+  m_pQueue->pop();
+  return true;
+}
+
+void EventReader::SkipValue() {
+  if (!Fill()) {
+    return;
+  }
+
+  int depth = 0;
+  do {
+    switch (m_pQueue->front().type) {
+      case Event::DOCUMENT_START:
+      case Event::SEQUENCE_START:
+      case Event::MAP_START:
+        depth++;
+        break;
+      case Event::SEQUENCE_END:
+      case Event::MAP_END:
+      case Event::DOCUMENT_END:
+        if (depth == 0) {
+          // nothing to skip
+          return;
+        }
+        depth--;
+        break;
+      default:
+        break;
+    }
+    m_pQueue->pop();
+  } while (depth > 0 && Fill());
+}
+
+bool EventReader::Fill() {
+  while (m_pQueue->empty()) {
+    if (!m_pDocument) {
+      if (!m_parser.PrepareNextDocument()) {
+        return false;
+      }
+      m_pDocument.reset(new SingleDocParser(*m_parser.m_pScanner,
+                                            *m_parser.m_pDirectives));
+    }
+
+    ViewEventHandler& queue = *m_pQueue;
+    if (!m_pDocument->HandleStep(queue)) {
+      m_pDocument.reset();
+    }
+  }
+  return true;
+}
+}
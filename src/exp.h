@@ -53,6 +53,90 @@ struct static_min<A, B, C...> {
         static_max<A, C...>::value : static_max<B, C...>::value;
 };
 
+template <bool... B>
+struct static_all;
+
+template <>
+struct static_all<> {
+    static const bool value = true;
+};
+template <bool A, bool... B>
+struct static_all<A, B...> {
+    static const bool value = A && static_all<B...>::value;
+};
+
+// Expressions that always match exactly one character (Char, Range, and
+// OR and NOT over those) are "classes": they set single_char and provide a
+// constexpr contains(). The OR below folds runs of classes into one
+// CharSet, which tests a character with a single table lookup.
+
+template <std::size_t... I>
+struct Indices {};
+
+template <std::size_t N, std::size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <std::size_t... I>
+struct MakeIndices<0, I...> {
+  using type = Indices<I...>;
+};
+
+template <typename... E>
+struct CharSet;
+
+template <>
+struct CharSet<> {
+  static constexpr bool contains(char) { return false; }
+};
+
+template <typename A, typename... B>
+struct CharSet<A, B...> {
+  static constexpr bool contains(char ch) {
+    return A::contains(ch) || CharSet<B...>::contains(ch);
+  }
+};
+
+template <typename Set, typename I = typename MakeIndices<256>::type>
+struct CharTable;
+
+template <typename Set, std::size_t... I>
+struct CharTable<Set, Indices<I...>> {
+  static constexpr bool value[256] = {Set::contains(static_cast<char>(I))...};
+
+  REGEXP_INLINE static bool Contains(char ch) {
+    return value[static_cast<unsigned char>(ch)];
+  }
+};
+
+template <typename Set, std::size_t... I>
+constexpr bool CharTable<Set, Indices<I...>>::value[256];
+
+// Tests one character against the classes gathered in a CharSet; a lone
+// class is cheaper to test directly.
+template <typename Set>
+struct SetMatch {
+  template <std::size_t N>
+  REGEXP_INLINE static bool match(Source<N> source, const size_t pos) {
+    return CharTable<Set>::Contains(source[pos]);
+  }
+};
+
+template <>
+struct SetMatch<CharSet<>> {
+  template <std::size_t N>
+  REGEXP_INLINE static bool match(Source<N>, const size_t) {
+    return false;
+  }
+};
+
+template <typename A>
+struct SetMatch<CharSet<A>> {
+  template <std::size_t N>
+  REGEXP_INLINE static bool match(Source<N> source, const size_t pos) {
+    return A::match(source, pos) >= 0;
+  }
+};
+
 template <char A>
 struct Char {
   template <std::size_t N>
@@ -60,11 +144,52 @@ struct Char {
     //if (likely(source[pos] != A)) { return -1;  } else { return 1; }
     if (unlikely(source[pos] == A)) { return 1;  } else { return -1; }
   }
+  static constexpr bool contains(char ch) { return ch == A; }
+  static const bool single_char = true;
   static const std::size_t lookahead = 1;
   static const std::size_t min_match = 1;
   static const std::size_t max_match = 1;
 };
 
+// Returns the match of the first of E... that matches, with runs of classes
+// gathered into Set and tested together.
+template <typename Set, typename... E>
+struct FirstOf;
+
+template <bool Class, typename Set, typename... E>
+struct FirstOfStep;
+
+template <typename... S>
+struct FirstOf<CharSet<S...>> {
+  template <std::size_t N>
+  REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
+    return SetMatch<CharSet<S...>>::match(source, pos) ? 1 : -1;
+  }
+};
+
+template <typename... S, typename A, typename... B>
+struct FirstOf<CharSet<S...>, A, B...>
+    : FirstOfStep<A::single_char, CharSet<S...>, A, B...> {};
+
+template <typename... S, typename A, typename... B>
+struct FirstOfStep<true, CharSet<S...>, A, B...>
+    : FirstOf<CharSet<S..., A>, B...> {};
+
+template <typename... S, typename A, typename... B>
+struct FirstOfStep<false, CharSet<S...>, A, B...> {
+  template <std::size_t N>
+  REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
+    if (SetMatch<CharSet<S...>>::match(source, pos)) {
+      return 1;
+    }
+    int match = A::match(source, pos);
+    if (match >= 0) {
+      return match;
+    }
+    return FirstOf<CharSet<>, B...>::match(source, pos);
+  }
+};
+
 template <typename A, typename... B>
 struct OR {
     template <std::size_t N, typename MA = A>
@@ -73,11 +198,7 @@ struct OR {
         //                             static_min<B::min_match...>::value !=
         //                             static_max<B::max_match...>::value, int>::type = 0>
   REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
-    int match = A::match(source, pos);
-    if (match >= 0) {
-      return match;
-    }
-    return OR<B...>::match(source, pos);
+    return FirstOf<CharSet<>, A, B...>::match(source, pos);
   }
 
   // template <std::size_t N, typename MA = A,
@@ -120,6 +241,11 @@ struct OR {
   //   return OR<B...>::match(source, pos);
   // }
 
+  static constexpr bool contains(char ch) {
+    return CharSet<A, B...>::contains(ch);
+  }
+  static const bool single_char =
+      static_all<A::single_char, B::single_char...>::value;
   static const std::size_t lookahead = static_max<A::lookahead, B::lookahead...>::value;
   static const std::size_t min_match = static_min<A::min_match, B::min_match...>::value;
   static const std::size_t max_match = static_max<A::max_match, B::max_match...>::value;
@@ -131,6 +257,8 @@ struct OR<A> {
   REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
     return A::match(source, pos);
   }
+  static constexpr bool contains(char ch) { return A::contains(ch); }
+  static const bool single_char = A::single_char;
   static const std::size_t lookahead = A::lookahead;
   static const std::size_t min_match = A::min_match;
   static const std::size_t max_match = A::max_match;
@@ -190,6 +318,7 @@ struct SEQ {
     if (b < 0) { return -1; }
     return A::lookahead + b;
   }
+  static const bool single_char = false;
   static const std::size_t lookahead = static_sum<A::lookahead, B::lookahead...>::value;
   static const std::size_t min_match = static_sum<A::min_match, B::min_match...>::value;
   static const std::size_t max_match = static_sum<A::max_match, B::max_match...>::value;
@@ -201,6 +330,7 @@ struct SEQ<A> {
   REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
     return A::match(source, pos);
   }
+  static const bool single_char = false;
   static const std::size_t lookahead = A::lookahead;
   static const std::size_t min_match = A::min_match;
   static const std::size_t max_match = A::max_match;
@@ -213,6 +343,8 @@ struct NOT {
   REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
      return A::match(source, pos) >= 0 ? -1 : 1;
   }
+  static constexpr bool contains(char ch) { return !A::contains(ch); }
+  static const bool single_char = A::single_char;
   static const std::size_t lookahead = A::lookahead;
   static const std::size_t min_match = A::min_match;
   static const std::size_t max_match = A::max_match;
@@ -225,6 +357,8 @@ struct Range {
   REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
     return (source[pos] < A || source[pos] > Z) ? -1 : 1;
   }
+  static constexpr bool contains(char ch) { return ch >= A && ch <= Z; }
+  static const bool single_char = true;
   static const std::size_t lookahead = 1;
   static const std::size_t min_match = 1;
   static const std::size_t max_match = 1;
@@ -235,6 +369,7 @@ struct Empty {
   REGEXP_INLINE static int match(Source<N> source, const size_t pos) {
     return source[pos] == Stream::eof() ? 0 : -1;
   }
+  static const bool single_char = false;
   static const std::size_t lookahead = 1;
   static const std::size_t min_match = 0;
   static const std::size_t max_match = 1;
@@ -251,6 +386,7 @@ struct Count {
     if (b < 0) { return pos + a; }
     return a + b;
   }
+  static const bool single_char = false;
   static const std::size_t lookahead = static_sum<A::lookahead, B::lookahead...>::value;
   // TODO check this again when using SEQ<Count...>
   static const std::size_t min_match = static_sum<A::min_match, B::min_match...>::value;
@@ -265,6 +401,7 @@ struct Count<A> {
     if (a > 0) return a;
     return 0;
   }
+  static const bool single_char = false;
   static const std::size_t lookahead = A::lookahead;
   static const std::size_t min_match = A::min_match;
   static const std::size_t max_match = A::max_match;
@@ -278,6 +415,7 @@ struct BreakT {
         source[pos+1] == '\n') return 2;
     return -1;
   }
+  static const bool single_char = false;
   static const std::size_t lookahead = 2;
   static const std::size_t min_match = 1;
   static const std::size_t max_match = 2;
@@ -290,6 +428,8 @@ struct BlankT {
         (source[pos] == '\t')) return 1;
     return -1;
   }
+  static constexpr bool contains(char ch) { return ch == ' ' || ch == '\t'; }
+  static const bool single_char = true;
   static const std::size_t lookahead = 1;
   static const std::size_t min_match = 1;
   static const std::size_t max_match = 1;
@@ -306,6 +446,7 @@ struct BlankOrBreakT {
         (source[pos+1] == '\n')) return 2;
     return -1;
   }
+  static const bool single_char = false;
   static const std::size_t lookahead = 2;
   static const std::size_t min_match = 1;
   static const std::size_t max_match = 2;
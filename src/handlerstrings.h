@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "token.h"
+#include "yaml-cpp/eventhandler.h"
+#include "yaml-cpp/vieweventhandler.h"
+
+namespace YAML {
+/**
+ * How each kind of handler is given its strings: an EventHandler gets tags
+ * as strings and scalars it may keep, and a ViewEventHandler gets views of
+ * whatever the parser already holds.
+ */
+template <typename Handler>
+struct HandlerStrings;
+
+template <>
+struct HandlerStrings<EventHandler> {
+  typedef const std::string& Tag;
+  typedef std::string Value;
+
+  static Tag MakeTag(const std::string& tag) { return tag; }
+  static Value MakeValue(const char* data, std::size_t size) {
+    return std::string(data, size);
+  }
+  static Value MakeValue(std::string& value) { return std::move(value); }
+  static Value MakeValue(Token& token) { return std::move(token.ownedValue()); }
+};
+
+template <>
+struct HandlerStrings<ViewEventHandler> {
+  typedef StringView Tag;
+  typedef StringView Value;
+
+  static Tag MakeTag(const std::string& tag) {
+    return StringView{tag.data(), tag.size()};
+  }
+  static Value MakeValue(const char* data, std::size_t size) {
+    return StringView{data, size};
+  }
+  static Value MakeValue(std::string& value) {
+    return StringView{value.data(), value.size()};
+  }
+  static Value MakeValue(Token& token) {
+    const detail::string_view scalar = token.scalar();
+    return StringView{scalar.str, scalar.length};
+  }
+};
+}
@@ -0,0 +1,609 @@
+#include "jsonparser.h"
+
+#include <cstring>
+
+#include "handlerstrings.h"
+#include "yaml-cpp/anchor.h"
+#include "yaml-cpp/emitterstyle.h"
+#include "yaml-cpp/eventhandler.h"
+#include "yaml-cpp/vieweventhandler.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace YAML {
+namespace {
+// One bit per byte of a 64 byte block, for each class of character that
+// the index cares about.
+struct Block {
+  std::uint64_t quote;
+  std::uint64_t backslash;
+  std::uint64_t op;
+  std::uint64_t whitespace;
+  std::uint64_t control;
+  std::uint64_t cr;
+  std::uint64_t lf;
+};
+
+#if defined(__SSE2__)
+inline std::uint64_t Bits(__m128i match, int shift) {
+  return static_cast<std::uint64_t>(
+             static_cast<unsigned>(_mm_movemask_epi8(match)))
+         << shift;
+}
+
+inline __m128i Equal(__m128i v, char ch) {
+  return _mm_cmpeq_epi8(v, _mm_set1_epi8(ch));
+}
+#endif
+
+Block Classify(const char* in) {
+  Block block = {0, 0, 0, 0, 0, 0, 0};
+#if defined(__SSE2__)
+  for (int i = 0; i < 4; i++) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i));
+    const int shift = 16 * i;
+    const __m128i cr = Equal(v, '\r');
+    const __m128i lf = Equal(v, '\n');
+
+    block.quote |= Bits(Equal(v, '\"'), shift);
+    block.backslash |= Bits(Equal(v, '\\'), shift);
+    block.op |= Bits(
+        _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(Equal(v, '{'), Equal(v, '}')),
+                         _mm_or_si128(Equal(v, '['), Equal(v, ']'))),
+            _mm_or_si128(Equal(v, ':'), Equal(v, ','))),
+        shift);
+    block.whitespace |= Bits(
+        _mm_or_si128(_mm_or_si128(Equal(v, ' '), Equal(v, '\t')),
+                     _mm_or_si128(cr, lf)),
+        shift);
+    // unsigned v <= 0x1F
+    const __m128i limit = _mm_set1_epi8(0x1F);
+    block.control |=
+        Bits(_mm_cmpeq_epi8(_mm_max_epu8(v, limit), limit), shift);
+    block.cr |= Bits(cr, shift);
+    block.lf |= Bits(lf, shift);
+  }
+#else
+  for (int i = 0; i < 64; i++) {
+    const std::uint64_t bit = std::uint64_t(1) << i;
+    const unsigned char ch = static_cast<unsigned char>(in[i]);
+    switch (ch) {
+      case '\"':
+        block.quote |= bit;
+        break;
+      case '\\':
+        block.backslash |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        block.op |= bit;
+        break;
+      case '\r':
+        block.cr |= bit;
+        break;
+      case '\n':
+        block.lf |= bit;
+        break;
+      default:
+        break;
+    }
+    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+      block.whitespace |= bit;
+    }
+    if (ch <= 0x1F) {
+      block.control |= bit;
+    }
+  }
+#endif
+  return block;
+}
+
+// Returns the characters that follow an odd run of backslashes, i.e. the
+// escaped ones. 'carry' says whether the first character of the block is
+// escaped, and is updated for the next block.
+std::uint64_t FindEscaped(std::uint64_t backslash, std::uint64_t& carry) {
+  const std::uint64_t evenBits = 0x5555555555555555ULL;
+
+  backslash &= ~carry;
+  const std::uint64_t followsEscape = (backslash << 1) | carry;
+  const std::uint64_t oddStarts = backslash & ~evenBits & ~followsEscape;
+
+  // adding the run starts to the runs carries each odd-started run past its
+  // end, which tells runs of odd and even length apart
+  const std::uint64_t sum = oddStarts + backslash;
+  carry = sum < oddStarts ? 1 : 0;
+  const std::uint64_t invert = sum << 1;
+  return (evenBits ^ invert) & followsEscape;
+}
+
+// Sets every bit from each set bit up to (not including) the next one.
+std::uint64_t PrefixXor(std::uint64_t bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+bool IsDelimiter(char ch) {
+  switch (ch) {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+    case '\"':
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsDigit(char ch) { return ch >= '0' && ch <= '9'; }
+
+int HexDigit(char ch) {
+  if (ch >= '0' && ch <= '9') {
+    return ch - '0';
+  } else if (ch >= 'a' && ch <= 'f') {
+    return ch - 'a' + 10;
+  } else if (ch >= 'A' && ch <= 'F') {
+    return ch - 'A' + 10;
+  }
+  return -1;
+}
+
+// Reads the four hex digits of a \u escape, or returns -1.
+long ReadHex4(const char* in) {
+  long value = 0;
+  for (int i = 0; i < 4; i++) {
+    int digit = HexDigit(in[i]);
+    if (digit < 0) {
+      return -1;
+    }
+    value = (value << 4) | digit;
+  }
+  return value;
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool IsNumber(const char* in, const char* end) {
+  if (in != end && *in == '-') {
+    ++in;
+  }
+  if (in == end) {
+    return false;
+  }
+  if (*in == '0') {
+    ++in;
+  } else if (IsDigit(*in)) {
+    while (in != end && IsDigit(*in)) {
+      ++in;
+    }
+  } else {
+    return false;
+  }
+
+  if (in != end && *in == '.') {
+    ++in;
+    if (in == end || !IsDigit(*in)) {
+      return false;
+    }
+    while (in != end && IsDigit(*in)) {
+      ++in;
+    }
+  }
+
+  if (in != end && (*in == 'e' || *in == 'E')) {
+    ++in;
+    if (in != end && (*in == '+' || *in == '-')) {
+      ++in;
+    }
+    if (in == end || !IsDigit(*in)) {
+      return false;
+    }
+    while (in != end && IsDigit(*in)) {
+      ++in;
+    }
+  }
+  return in == end;
+}
+}  // namespace
+
+JsonParser::JsonParser(const char* data, std::size_t size, const Mark& start)
+    : m_data(data),
+      m_size(size),
+      m_start(start),
+      m_index(),
+      m_events(),
+      m_markOffset(0),
+      m_lineStart(0),
+      m_line(0) {}
+
+JsonParser::~JsonParser() {}
+
+// Parse
+// . Beyond the JSON grammar, YAML only accepts a key (here, always a string)
+//   on the same line as its ':', and no more than 1024 characters before it.
+//   YAML also knows more escapes than JSON, but reads all of JSON's the same
+//   way except for surrogates, which it rejects.
+// . Anything that is not accepted is left to the YAML parser, to be read
+//   (or rejected) as it always has been.
+bool JsonParser::Parse() {
+  // marks are ints
+  if (m_size == 0 || m_size > 0x7FFFFFFF) {
+    return false;
+  }
+  return BuildIndex() && BuildEvents();
+}
+
+bool JsonParser::BuildIndex() {
+  m_index.clear();
+  m_index.reserve(m_size / 8);
+
+  std::uint64_t escapedCarry = 0;
+  std::uint64_t inStringCarry = 0;
+  std::uint64_t bareCarry = 0;
+  std::uint64_t crCarry = 0;
+
+  for (std::size_t pos = 0; pos < m_size; pos += 64) {
+    const char* in = m_data + pos;
+    char padded[64];
+    if (m_size - pos < 64) {
+      std::memset(padded, ' ', sizeof(padded));
+      std::memcpy(padded, in, m_size - pos);
+      in = padded;
+    }
+
+    const Block block = Classify(in);
+
+    // a string runs from its opening quote up to its closing one
+    const std::uint64_t quote =
+        block.quote & ~FindEscaped(block.backslash, escapedCarry);
+    const std::uint64_t inString = PrefixXor(quote) ^ inStringCarry;
+    inStringCarry =
+        static_cast<std::uint64_t>(static_cast<std::int64_t>(inString) >> 63);
+
+    // JSON strings can't hold control characters, and YAML doesn't take a CR
+    // without an LF as a line break
+    if (block.control & inString) {
+      return false;
+    }
+    const std::uint64_t afterCr = (block.cr << 1) | crCarry;
+    crCarry = block.cr >> 63;
+    if (afterCr & ~block.lf) {
+      return false;
+    }
+
+    // bare values (numbers, true, false and null) are indexed by their first
+    // character
+    const std::uint64_t bare =
+        ~(block.op | block.whitespace | quote | inString);
+    const std::uint64_t bareStarts = bare & ~((bare << 1) | bareCarry);
+    bareCarry = bare >> 63;
+
+    std::uint64_t structural = (block.op & ~inString) | quote | bareStarts;
+    while (structural) {
+      m_index.push_back(
+          static_cast<std::uint32_t>(pos + __builtin_ctzll(structural)));
+      structural &= structural - 1;
+    }
+  }
+
+  return !inStringCarry && !crCarry;
+}
+
+bool JsonParser::BuildEvents() {
+  m_events.clear();
+  m_events.reserve(m_index.size());
+
+  const std::size_t count = m_index.size();
+  std::vector<char> open;
+  std::size_t i = 0;
+
+  if (count == 0 || (m_data[m_index[0]] != '{' && m_data[m_index[0]] != '[')) {
+    return false;
+  }
+
+  while (true) {
+    // a value
+    if (i == count) {
+      return false;
+    }
+    const std::uint32_t at = m_index[i++];
+    const char ch = m_data[at];
+    bool opened = false;
+    bool expectKey = false;
+    if (ch == '{' || ch == '[') {
+      const char close = (ch == '{' ? '}' : ']');
+      m_events.push_back({ch == '{' ? Event::MAP_START : Event::SEQ_START, at,
+                          0, MarkAt(at)});
+      if (i < count && m_data[m_index[i]] == close) {
+        m_events.push_back(
+            {ch == '{' ? Event::MAP_END : Event::SEQ_END, m_index[i], 0,
+             Mark()});
+        i++;
+      } else {
+        open.push_back(ch);
+        opened = true;
+        expectKey = (ch == '{');
+      }
+    } else if (ch == '\"') {
+      if (!AddString(i, at)) {
+        return false;
+      }
+    } else if (IsDelimiter(ch) || !AddBareValue(at)) {
+      return false;
+    }
+
+    // after a complete value, the end of any number of collections and then
+    // a ','
+    if (!opened) {
+      while (!open.empty()) {
+        if (i == count) {
+          return false;
+        }
+        const std::uint32_t next = m_index[i++];
+        if (m_data[next] == ',') {
+          expectKey = (open.back() == '{');
+          break;
+        }
+        if (m_data[next] != (open.back() == '{' ? '}' : ']')) {
+          return false;
+        }
+        m_events.push_back({open.back() == '{' ? Event::MAP_END
+                                               : Event::SEQ_END,
+                            next, 0, Mark()});
+        open.pop_back();
+      }
+
+      if (open.empty()) {
+        return i == count;
+      }
+    }
+
+    if (expectKey) {
+      if (i == count || m_data[m_index[i]] != '\"') {
+        return false;
+      }
+      const std::uint32_t key = m_index[i++];
+      if (!AddString(i, key) || i == count || m_data[m_index[i]] != ':') {
+        return false;
+      }
+
+      // YAML's rules for a simple key
+      const std::uint32_t colon = m_index[i++];
+      if (colon - key > 1024 ||
+          std::memchr(m_data + key, '\n', colon - key) != nullptr) {
+        return false;
+      }
+    }
+  }
+}
+
+bool JsonParser::AddString(std::size_t& next, std::uint32_t begin) {
+  // the closing quote is always indexed right after the opening one
+  if (next == m_index.size()) {
+    return false;
+  }
+  const std::uint32_t end = m_index[next++];
+
+  Event event = {Event::STRING, begin + 1, end - begin - 1, MarkAt(begin)};
+
+  const char* in = m_data + event.begin;
+  const char* const last = in + event.size;
+  while ((in = static_cast<const char*>(
+              std::memchr(in, '\\', static_cast<std::size_t>(last - in))))) {
+    event.type = Event::ESCAPED_STRING;
+    switch (in[1]) {
+      case '\"':
+      case '\\':
+      case '/':
+      case 'b':
+      case 'f':
+      case 'n':
+      case 'r':
+      case 't':
+        in += 2;
+        break;
+      case 'u': {
+        if (last - in < 6) {
+          return false;
+        }
+        const long value = ReadHex4(in + 2);
+        if (value < 0 || (value >= 0xD800 && value <= 0xDFFF)) {
+          return false;
+        }
+        in += 6;
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+
+  m_events.push_back(event);
+  return true;
+}
+
+bool JsonParser::AddBareValue(std::uint32_t begin) {
+  const char* const in = m_data + begin;
+  const char* end = in;
+  const char* const last = m_data + m_size;
+  while (end != last && !IsDelimiter(*end)) {
+    ++end;
+  }
+
+  const std::size_t size = static_cast<std::size_t>(end - in);
+  Event::TYPE type = Event::PLAIN;
+  if (size == 4 && std::memcmp(in, "null", 4) == 0) {
+    type = Event::NULL_VALUE;
+  } else if (!(size == 4 && std::memcmp(in, "true", 4) == 0) &&
+             !(size == 5 && std::memcmp(in, "false", 5) == 0) &&
+             !IsNumber(in, end)) {
+    return false;
+  }
+
+  // YAML trims spaces after a plain scalar, but only trims tabs at the end of
+  // a line
+  bool tab = false;
+  for (; end != last && (*end == ' ' || *end == '\t'); ++end) {
+    tab |= (*end == '\t');
+  }
+  if (tab && end != last && *end != '\n' && *end != '\r') {
+    return false;
+  }
+
+  m_events.push_back(
+      {type, begin, static_cast<std::uint32_t>(size), MarkAt(begin)});
+  return true;
+}
+
+// Marks are asked for in input order, so the lines are counted as we go.
+Mark JsonParser::MarkAt(std::uint32_t offset) {
+  if (m_start.is_offset_only()) {
+    return Mark::offset_mark(m_start.pos + static_cast<int>(offset));
+  }
+
+  const char* in = m_data + m_markOffset;
+  const char* const end = m_data + offset;
+  while ((in = static_cast<const char*>(
+              std::memchr(in, '\n', static_cast<std::size_t>(end - in))))) {
+    ++in;
+    m_line++;
+    m_lineStart = static_cast<std::uint32_t>(in - m_data);
+  }
+  m_markOffset = offset;
+
+  Mark mark;
+  mark.pos = m_start.pos + static_cast<int>(offset);
+  mark.line = m_start.line + m_line;
+  mark.column = (m_line == 0 ? m_start.column + static_cast<int>(offset)
+                             : static_cast<int>(offset - m_lineStart));
+  return mark;
+}
+
+template <typename Handler>
+void JsonParser::HandleDocument(Handler& eventHandler) const {
+  typedef HandlerStrings<Handler> Strings;
+  static const std::string plainTag("?");
+  static const std::string quotedTag("!");
+
+  eventHandler.OnDocumentStart(m_events.front().mark);
+
+  std::string value;
+  for (const Event& event : m_events) {
+    switch (event.type) {
+      case Event::MAP_START:
+        eventHandler.OnMapStart(event.mark, Strings::MakeTag(plainTag),
+                                NullAnchor, EmitterStyle::Flow);
+        break;
+      case Event::MAP_END:
+        eventHandler.OnMapEnd();
+        break;
+      case Event::SEQ_START:
+        eventHandler.OnSequenceStart(event.mark, Strings::MakeTag(plainTag),
+                                     NullAnchor, EmitterStyle::Flow);
+        break;
+      case Event::SEQ_END:
+        eventHandler.OnSequenceEnd();
+        break;
+      case Event::STRING:
+        eventHandler.OnScalar(event.mark, Strings::MakeTag(quotedTag),
+                              NullAnchor,
+                              Strings::MakeValue(m_data + event.begin,
+                                                 event.size));
+        break;
+      case Event::ESCAPED_STRING:
+        Unescape(event, value);
+        eventHandler.OnScalar(event.mark, Strings::MakeTag(quotedTag),
+                              NullAnchor, Strings::MakeValue(value));
+        break;
+      case Event::PLAIN:
+        eventHandler.OnScalar(event.mark, Strings::MakeTag(plainTag),
+                              NullAnchor,
+                              Strings::MakeValue(m_data + event.begin,
+                                                 event.size));
+        break;
+      case Event::NULL_VALUE:
+        eventHandler.OnNull(event.mark, NullAnchor);
+        break;
+    }
+  }
+
+  eventHandler.OnDocumentEnd();
+}
+
+template void JsonParser::HandleDocument(EventHandler& eventHandler) const;
+template void JsonParser::HandleDocument(ViewEventHandler& eventHandler) const;
+
+void JsonParser::Unescape(const Event& event, std::string& value) const {
+  const char* in = m_data + event.begin;
+  const char* const last = in + event.size;
+  value.clear();
+
+  while (in != last) {
+    const char* escape = static_cast<const char*>(
+        std::memchr(in, '\\', static_cast<std::size_t>(last - in)));
+    if (!escape) {
+      value.append(in, last);
+      break;
+    }
+    value.append(in, escape);
+
+    const char ch = escape[1];
+    in = escape + 2;
+    switch (ch) {
+      case 'b':
+        value += '\x08';
+        break;
+      case 'f':
+        value += '\x0C';
+        break;
+      case 'n':
+        value += '\x0A';
+        break;
+      case 'r':
+        value += '\x0D';
+        break;
+      case 't':
+        value += '\x09';
+        break;
+      case 'u': {
+        // surrogates were turned away by Parse
+        const unsigned long code = static_cast<unsigned long>(ReadHex4(in));
+        in += 4;
+        if (code <= 0x7F) {
+          value += static_cast<char>(code);
+        } else if (code <= 0x7FF) {
+          value += static_cast<char>(0xC0 + (code >> 6));
+          value += static_cast<char>(0x80 + (code & 0x3F));
+        } else {
+          value += static_cast<char>(0xE0 + (code >> 12));
+          value += static_cast<char>(0x80 + ((code >> 6) & 0x3F));
+          value += static_cast<char>(0x80 + (code & 0x3F));
+        }
+        break;
+      }
+      default:
+        // '"', '\\' and '/' stand for themselves
+        value += ch;
+        break;
+    }
+  }
+}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "yaml-cpp/mark.h"
+#include "yaml-cpp/noncopyable.h"
+
+namespace YAML {
+class EventHandler;
+class ViewEventHandler;
+
+/**
+ * A parser for documents that are a single JSON object or array, as a fast
+ * path past the scanner. It produces exactly the events (and marks) that
+ * SingleDocParser would for the same input.
+ *
+ * The input is first indexed: every quote, structural character and start
+ * of a bare value outside of strings is found 64 bytes at a time. The index
+ * is then checked against the JSON grammar, and against the few places
+ * where YAML reads JSON differently (see Parse), before any event is sent.
+ */
+class JsonParser : private noncopyable {
+ public:
+  /**
+   * The input must stay put for the life of the parser; {@code start} is the
+   * mark of its first character. If that mark is only an offset, so are the
+   * marks of the events, and lines aren't counted.
+   */
+  JsonParser(const char* data, std::size_t size, const Mark& start);
+  ~JsonParser();
+
+  /**
+   * Returns true if the input is a JSON object or array (with nothing but
+   * whitespace around it) that reads the same as YAML. Otherwise nothing
+   * has been sent, and the input should be parsed as YAML.
+   */
+  bool Parse();
+
+  /**
+   * Sends the document that Parse accepted to {@code eventHandler}, an
+   * EventHandler or a ViewEventHandler.
+   */
+  template <typename Handler>
+  void HandleDocument(Handler& eventHandler) const;
+
+ private:
+  struct Event {
+    enum TYPE : char {
+      MAP_START,
+      MAP_END,
+      SEQ_START,
+      SEQ_END,
+      STRING,
+      ESCAPED_STRING,
+      PLAIN,
+      NULL_VALUE
+    };
+
+    TYPE type;
+    std::uint32_t begin;
+    std::uint32_t size;
+    Mark mark;
+  };
+
+  /** Stage one: fills m_index. */
+  bool BuildIndex();
+
+  /** Stage two: fills m_events from m_index. */
+  bool BuildEvents();
+
+  bool AddString(std::size_t& next, std::uint32_t begin);
+  bool AddBareValue(std::uint32_t begin);
+  Mark MarkAt(std::uint32_t offset);
+
+  void Unescape(const Event& event, std::string& value) const;
+
+ private:
+  const char* const m_data;
+  const std::size_t m_size;
+  const Mark m_start;
+
+  std::vector<std::uint32_t> m_index;
+  std::vector<Event> m_events;
+
+  // where MarkAt last left off
+  std::uint32_t m_markOffset;
+  std::uint32_t m_lineStart;
+  int m_line;
+};
+}
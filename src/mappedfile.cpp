@@ -0,0 +1,64 @@
+#include "mappedfile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define YAML_CPP_HAS_MMAP
+#endif
+
+namespace YAML {
+#ifdef YAML_CPP_HAS_MMAP
+MappedFile::MappedFile(const std::string& filename)
+    : m_data(nullptr), m_size(0), m_mapped(false) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  // Only regular files can be mapped; pipes, FIFOs and devices are left to
+  // the istream fallback.
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return;
+  }
+
+  m_size = static_cast<std::size_t>(st.st_size);
+  if (m_size == 0) {
+    // mmap refuses empty mappings
+    ::close(fd);
+    m_data = "";
+    m_mapped = true;
+    return;
+  }
+
+  void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+
+  if (addr == MAP_FAILED) {
+    m_size = 0;
+    return;
+  }
+
+#ifdef MADV_SEQUENTIAL
+  ::madvise(addr, m_size, MADV_SEQUENTIAL);
+#endif
+
+  m_data = static_cast<const char*>(addr);
+  m_mapped = true;
+}
+
+MappedFile::~MappedFile() {
+  if (m_mapped && m_size > 0) {
+    ::munmap(const_cast<char*>(m_data), m_size);
+  }
+}
+#else
+MappedFile::MappedFile(const std::string&)
+    : m_data(nullptr), m_size(0), m_mapped(false) {}
+
+MappedFile::~MappedFile() {}
+#endif
+}
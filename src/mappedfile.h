@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "yaml-cpp/noncopyable.h"
+
+namespace YAML {
+/**
+ * A read-only memory mapping of a whole file.
+ *
+ * Evaluates to false if the file could not be mapped (missing file, pipe,
+ * character device or a platform without mmap); callers should then fall back
+ * to reading the file through an std::istream.
+ */
+class MappedFile : private noncopyable {
+ public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  explicit operator bool() const { return m_mapped; }
+
+  const char* data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+
+ private:
+  const char* m_data;
+  std::size_t m_size;
+  bool m_mapped;
+};
+}
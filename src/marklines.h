@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "yaml-cpp/mark.h"
+
+namespace YAML {
+namespace detail {
+// The start of every line that a mark was set on, with its line number, in
+// input order.
+struct mark_lines {
+  typedef std::pair<int, int> line;  // start, number
+  std::vector<line> starts;
+
+  void add(int start, int number) {
+    if (starts.empty() || starts.back().first < start) {
+      starts.emplace_back(start, number);
+      return;
+    }
+    if (starts.back().first == start) {
+      return;
+    }
+    // marks nearly always come in input order
+    auto it = std::lower_bound(starts.begin(), starts.end(),
+                               line(start, number));
+    if (it == starts.end() || it->first != start) {
+      starts.insert(it, line(start, number));
+    }
+  }
+
+  Mark find(int pos) const {
+    auto it = std::upper_bound(starts.begin(), starts.end(),
+                               line(pos, std::numeric_limits<int>::max()));
+    if (it == starts.begin()) {
+      return Mark::offset_mark(pos);
+    }
+    --it;
+    Mark mark;
+    mark.pos = pos;
+    mark.line = it->second;
+    mark.column = pos - it->first;
+    return mark;
+  }
+};
+}  // namespace detail
+}  // namespace YAML
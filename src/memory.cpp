@@ -2,16 +2,27 @@
 #include "yaml-cpp/node/detail/node.h"
 #include "yaml-cpp/node/ptr.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
+#include "marklines.h"
+
 namespace YAML {
 namespace detail {
 
+namespace {
+const std::size_t first_bucket_slots = 8;
+const std::size_t max_bucket_slots = 4096;
+}
+
+// A chunk of the arena that nodes are made in. Each slot holds a node and
+// room for its data, and slots are handed out from the front. A chunk is
+// twice the size of the one before it, up to max_bucket_slots; chunks are
+// linked newest first, and only the first one is ever used for new nodes.
 struct node_bucket {
-    static const size_t size = 64;
-    node_bucket(node_bucket* next_, size_t capacity) : next(next_) {
-        nodes.reserve(capacity);
-    }
+    explicit node_bucket(std::size_t capacity_)
+        : capacity(capacity_), used(0), slots(new slot[capacity_]) {}
 
     ~node_bucket();
     void clear();
@@ -27,35 +38,43 @@ struct node_bucket {
             n.set_data(reinterpret_cast<node_data*>(&data));
         }
     };
-    std::vector<value> nodes;
+    typedef std::aligned_storage<sizeof(value), alignof(value)>::type slot;
+
+    bool full() const { return used == capacity; }
+    value& at(std::size_t i) { return *reinterpret_cast<value*>(&slots[i]); }
+    value& emplace() {
+        value* v = new (&slots[used]) value;
+        used++;
+        return *v;
+    }
+
+    std::size_t capacity;
+    std::size_t used;
+    std::unique_ptr<slot[]> slots;
     std::unique_ptr<node_bucket> next = nullptr;
 };
 
 node_bucket::~node_bucket() {}
 
-node& memory::create_node() {
-    node_bucket* insert = buckets.get();
-
-    for (node_bucket* b = insert; b; b = b->next.get()) {
-        if (b->nodes.size() == b->nodes.capacity()) {
-            b = nullptr;
-            break;
-        }
-        insert = b;
-    }
-
-    if (insert && insert->nodes.size() < insert->nodes.capacity()) {
-        insert->nodes.emplace_back();
-        return insert->nodes.back().n;
+// Destroys the nodes, which lets go of their data; data that another chunk's
+// node still shares lives on until that node is destroyed.
+void node_bucket::clear() {
+    for (std::size_t i = 0; i < used; i++) {
+        at(i).~value();
     }
+    used = 0;
+}
 
-    if (!buckets) {
-        buckets = std::unique_ptr<node_bucket>(new node_bucket(nullptr, 8));
-    } else {
-        buckets = std::unique_ptr<node_bucket>(new node_bucket(buckets.release(), node_bucket::size));
+node& memory::create_node() {
+    if (!buckets || buckets->full()) {
+        const std::size_t capacity =
+            buckets ? std::min(buckets->capacity * 2, max_bucket_slots)
+                    : first_bucket_slots;
+        std::unique_ptr<node_bucket> bucket(new node_bucket(capacity));
+        bucket->next = std::move(buckets);
+        buckets = std::move(bucket);
     }
-    buckets->nodes.emplace_back();
-    return buckets->nodes.back().n;
+    return buckets->emplace().n;
 }
 
 void memory::merge(memory& rhs) {
@@ -67,46 +86,71 @@ void memory::merge(memory& rhs) {
         return;
     }
 
-    if (!buckets) {
-        buckets.reset(rhs.buckets.release());
-        return;
+    // rhs's nodes point at its line tables, which move here with them
+    for (auto& l : rhs.lines) {
+        lines.push_back(std::move(l));
+    }
+    rhs.lines.clear();
+    rhs.current_lines = nullptr;
+
+    // rhs's nodes point into its tag tables, which move here with them (a
+    // moved set keeps its strings where they are)
+    if (!rhs.tags.empty()) {
+        merged_tags.push_back(std::move(rhs.tags));
+        rhs.tags.clear();
     }
+    merged_tags.splice(merged_tags.end(), rhs.merged_tags);
 
-    // last before filled bucket
-    node_bucket* insert = nullptr;
-    for (node_bucket* b = buckets.get(); b; b = b->next.get()) {
-        if (b->nodes.size() == b->nodes.capacity()) {
-            break;
-        }
-        insert = b;
+    if (!buckets) {
+        buckets = std::move(rhs.buckets);
+        return;
     }
 
     node_bucket* last = rhs.buckets.get();
-    for (node_bucket* b = last; b; b = b->next.get()) {
-        last = b;
+    while (last->next) {
+        last = last->next.get();
     }
 
-    node_bucket* appendix = nullptr;
-    if (insert) {
-        appendix = insert->next.release();
-        insert->next.reset(rhs.buckets.release());
+    // new nodes go in whichever first chunk still has room
+    if (buckets->full()) {
+        last->next = std::move(buckets);
+        buckets = std::move(rhs.buckets);
     } else {
-        appendix = buckets.release();
-        buckets.reset(rhs.buckets.release());
+        last->next = std::move(buckets->next);
+        buckets->next = std::move(rhs.buckets);
+    }
+}
 
+void memory::set_mark(node& node, const Mark& mark) {
+    mark_lines* lines_seen = nullptr;
+    if (mark.line >= 0) {
+        if (!current_lines) {
+            lines.emplace_back(new mark_lines);
+            current_lines = lines.back().get();
+        }
+        current_lines->add(mark.pos - mark.column, mark.line);
+        lines_seen = current_lines;
     }
+    node.set_mark(mark.pos, lines_seen);
+}
 
-    if (appendix) {
-        last->next.reset(appendix);
+const std::string& memory::intern_tag(const std::string& tag) {
+    if (tag == node_data::tag_none) {
+        return node_data::tag_none;
+    } else if (tag == node_data::tag_other) {
+        return node_data::tag_other;
+    } else if (tag == node_data::tag_non_plain_scalar) {
+        return node_data::tag_non_plain_scalar;
     }
+    return *tags.insert(tag).first;
 }
 
-memory::memory() {}
+memory::memory() : current_lines(nullptr) {}
 memory::~memory() {
   // Important:
   // First clear all node_data refs
   for (node_bucket* b = buckets.get(); b; b = b->next.get()) {
-    b->nodes.clear();
+    b->clear();
   }
   // Then delete buckets
   while (buckets) {
@@ -10,6 +10,8 @@
 #include "yaml-cpp/node/ptr.h"
 #include "yaml-cpp/node/type.h"
 
+#include "marklines.h"
+
 namespace YAML {
 namespace detail {
 
@@ -26,20 +28,24 @@ node_data::node_data()
     : m_type(NodeType::Undefined),
       m_style(EmitterStyle::Default),
       m_hasUndefined(false),
-      m_mark(Mark::null_mark()),
+      m_markPos(-1),
+      m_markLines(nullptr),
       m_tag(nullptr) {}
 
+Mark node_data::mark() const {
+  if (m_markPos == -1) {
+    return Mark::null_mark();
+  }
+  return m_markLines ? m_markLines->find(m_markPos)
+                     : Mark::offset_mark(m_markPos);
+}
+
 void node_data::mark_defined() {
   if (m_type == NodeType::Undefined)
     m_type = NodeType::Null;
 }
 
 node_data::~node_data() {
-  if (m_tag &&
-     m_tag != &tag_other &&
-     m_tag != &tag_non_plain_scalar) {
-    delete m_tag;
-  }
   free_data();
 }
 
@@ -93,20 +99,8 @@ void node_data::set_type(NodeType::value type) {
   }
 }
 
-void node_data::set_tag(const std::string& tag) {
-  if (m_tag &&
-      m_tag != &tag_other &&
-      m_tag != &tag_non_plain_scalar) {
-    delete m_tag;
-  }
-
-  if (tag == tag_other) {
-    m_tag = &tag_other;
-  } else if (tag == tag_non_plain_scalar) {
-    m_tag = &tag_non_plain_scalar;
-  } else {
-    m_tag = new std::string(tag);
-  }
+void node_data::set_tag(const std::string& tag, shared_memory& pMemory) {
+  m_tag = &pMemory->intern_tag(tag);
 }
 
 void node_data::set_null() {
@@ -44,14 +44,14 @@ void NodeBuilder::OnScalar(const Mark& mark, const std::string& tag,
                            anchor_t anchor, std::string value) {
   detail::node& node = Push(mark, anchor);
   node.set_scalar(std::move(value));
-  node.set_tag(tag);
+  node.set_tag(tag, m_pMemory);
   Pop();
 }
 
 void NodeBuilder::OnSequenceStart(const Mark& mark, const std::string& tag,
                                   anchor_t anchor, EmitterStyle::value style) {
   detail::node& node = Push(mark, anchor);
-  node.set_tag(tag);
+  node.set_tag(tag, m_pMemory);
   node.set_type(NodeType::Sequence);
   node.set_style(style);
 }
@@ -62,7 +62,7 @@ void NodeBuilder::OnMapStart(const Mark& mark, const std::string& tag,
                              anchor_t anchor, EmitterStyle::value style) {
   detail::node& node = Push(mark, anchor);
   node.set_type(NodeType::Map);
-  node.set_tag(tag);
+  node.set_tag(tag, m_pMemory);
   node.set_style(style);
   m_mapDepth++;
 }
@@ -75,7 +75,7 @@ void NodeBuilder::OnMapEnd() {
 
 detail::node& NodeBuilder::Push(const Mark& mark, anchor_t anchor) {
   detail::node& node = m_pMemory->create_node();
-  node.set_mark(mark);
+  m_pMemory->set_mark(node, mark);
   RegisterAnchor(anchor, node);
   Push(node);
   return node;
@@ -4,8 +4,12 @@ namespace YAML {
 _Null Null;
 
 bool IsNullString(const std::string& str) {
+  return IsNullString(str.data(), str.size());
+}
+
+bool IsNullString(const char* str, std::size_t size) {
   // Match empty | ~ | null | Null | NULL
-  switch (str.size()) {
+  switch (size) {
   case 0:
       return true;
   case 1:
@@ -1,16 +1,26 @@
 #include "yaml-cpp/node/parse.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
-#include <sstream>
+#include <system_error>
+#include <thread>
 
+#include "documentmarker.h"
+#include "mappedfile.h"
 #include "yaml-cpp/node/node.h"
 #include "yaml-cpp/node/impl.h"
+#include "yaml-cpp/node/iterator.h"
+#include "yaml-cpp/node/convert.h"
+#include "yaml-cpp/node/detail/impl.h"
+#include "yaml-cpp/node/type.h"
 #include "yaml-cpp/parser.h"
 #include "yaml-cpp/nodebuilder.h"
 
 namespace YAML {
-Node Load(const std::string& input) {
-  Parser parser(input);
+namespace {
+Node LoadNextDocument(Parser& parser) {
   NodeBuilder builder;
   if (!parser.HandleNextDocument(builder)) {
     return Node();
@@ -19,22 +29,320 @@ Node Load(const std::string& input) {
   return builder.Root();
 }
 
-Node Load(const char* input) {
-  std::stringstream stream(input);
-  return Load(stream);
+std::vector<Node> LoadAllDocuments(Parser& parser) {
+  std::vector<Node> docs;
+
+  while (1) {
+    NodeBuilder builder;
+    if (!parser.HandleNextDocument(builder)) {
+      break;
+    }
+    docs.push_back(builder.Root());
+  }
+
+  return docs;
+}
+
+// Documents (or entries) are loaded side by side in runs of at least this
+// many bytes.
+const std::size_t MinRunSize = 32 * 1024;
+
+// A run of whole documents, or of whole entries of the root collection, in a
+// buffer, and the mark of its first byte.
+struct InputRun {
+  std::size_t begin, end;
+  Mark start;
+};
+
+unsigned ThreadCount(const ParseOptions& options) {
+  return options.threads ? options.threads
+                         : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Returns false if a '\n' byte in the buffer may not be a line break, as in
+// UTF-16 or UTF-32. Sets {@code bom} if it opens with a UTF-8 BOM.
+bool SplitsIntoLines(const char* input, std::size_t size, bool& bom) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(input);
+  bom = size >= 3 && std::memcmp(input, "\xEF\xBB\xBF", 3) == 0;
+  return bom || size < 2 ||
+         !(bytes[0] == 0 || bytes[1] == 0 || bytes[0] == 0xFE ||
+           bytes[0] == 0xFF);
+}
+
+// Starts a new run at the line at {@code pos}.
+void CutRun(std::vector<InputRun>& runs, InputRun& run, std::size_t pos,
+            int line, bool bom) {
+  run.end = pos;
+  runs.push_back(run);
+
+  // a leading BOM is not counted as part of the input
+  run.begin = pos;
+  run.start.pos = static_cast<int>(bom ? pos - 3 : pos);
+  run.start.line = line;
+}
+
+// Splits the buffer before "---" lines, into about four runs for each of
+// the {@code threads}. Returns false if its documents can't be loaded apart:
+// directives carry over from one document to the next.
+bool SplitDocuments(const char* input, std::size_t size, unsigned threads,
+                    std::vector<InputRun>& runs) {
+  bool bom;
+  if (!SplitsIntoLines(input, size, bom)) {
+    return false;
+  }
+
+  const std::size_t target = std::max(size / (threads * 4), MinRunSize);
+  InputRun run = {0, 0, Mark()};
+  std::size_t pos = 0;
+  int line = 0;
+  while (pos < size) {
+    const char* start = input + pos;
+    const char* newline =
+        static_cast<const char*>(std::memchr(start, '\n', size - pos));
+    const std::size_t length = newline ? newline - start + 1 : size - pos;
+    if (*start == '%') {
+      return false;
+    }
+
+    if (pos - run.begin >= target &&
+        IsDocumentMarker(start, length, newline, "---")) {
+      CutRun(runs, run, pos, line, bom);
+    }
+
+    pos += length;
+    line++;
+  }
+
+  run.end = size;
+  runs.push_back(run);
+  return true;
+}
+
+// Returns true if the line is an entry of a block sequence at its start.
+bool IsSequenceEntry(const char* line, std::size_t length) {
+  return line[0] == '-' &&
+         (length == 1 || line[1] == ' ' || line[1] == '\t' ||
+          line[1] == '\r' || line[1] == '\n');
+}
+
+// Returns true if a line starting with {@code ch} may be a plain or quoted
+// key of a block mapping at its start. Explicit ("?") keys, flow keys and
+// keys with properties are left alone.
+bool CanStartKey(char ch) {
+  return std::strchr(" \t\r\n#-?:,[]{}&*!|>%@`", ch) == nullptr;
+}
+
+// Splits a document whose root is a block sequence or a block mapping before
+// the entries at the start of a line, into about four runs for each of the
+// {@code threads}, and sets {@code type} to the kind of root. This is only a
+// guess (a key may really be the end of a quoted scalar, say), which the
+// caller has to check; it returns false where the guess is plainly wrong,
+// or where the runs can't be loaded apart because of directives or further
+// documents.
+bool SplitCollection(const char* input, std::size_t size, unsigned threads,
+                     std::vector<InputRun>& runs, NodeType::value& type) {
+  bool bom;
+  if (!SplitsIntoLines(input, size, bom)) {
+    return false;
+  }
+
+  const std::size_t target = std::max(size / (threads * 4), MinRunSize);
+  InputRun run = {0, 0, Mark()};
+  std::size_t pos = bom ? 3 : 0;
+  int line = 0;
+  bool started = false;
+  type = NodeType::Undefined;
+  while (pos < size) {
+    const char* start = input + pos;
+    const char* newline =
+        static_cast<const char*>(std::memchr(start, '\n', size - pos));
+    const std::size_t length = newline ? newline - start + 1 : size - pos;
+
+    if (IsDocumentMarker(start, length, newline, "---") ||
+        IsDocumentMarker(start, length, newline, "...")) {
+      // only the one document, which may follow comments
+      if (*start == '.' || type != NodeType::Undefined || started) {
+        return false;
+      }
+      started = true;
+    } else if (*start == '%') {
+      return false;
+    } else if (*start == ' ' || *start == '\t' || *start == '\r' ||
+               *start == '\n' || *start == '#') {
+      // inside an entry, or between two
+    } else if (type == NodeType::Undefined) {
+      // the first entry tells what the root is
+      if (IsSequenceEntry(start, length)) {
+        type = NodeType::Sequence;
+      } else if (CanStartKey(*start)) {
+        type = NodeType::Map;
+      } else {
+        return false;
+      }
+    } else if (pos - run.begin >= target &&
+               (type == NodeType::Sequence ? IsSequenceEntry(start, length)
+                                           : CanStartKey(*start))) {
+      CutRun(runs, run, pos, line, bom);
+    }
+
+    pos += length;
+    line++;
+  }
+
+  run.end = size;
+  runs.push_back(run);
+  return type != NodeType::Undefined;
+}
+
+// Calls {@code load} with the index of each run, on up to {@code threads}
+// threads. Returns false if any of the calls threw.
+template <typename Load>
+bool LoadRuns(const std::vector<InputRun>& runs, unsigned threads,
+              const Load& load) {
+  std::atomic<std::size_t> next(0);
+  std::atomic<bool> failed(false);
+  auto work = [&]() {
+    for (std::size_t i = next++; i < runs.size(); i = next++) {
+      try {
+        load(i);
+      } catch (...) {
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < threads && i < runs.size(); i++) {
+    try {
+      workers.emplace_back(work);
+    } catch (const std::system_error&) {
+      // make do with the threads we have
+      break;
+    }
+  }
+  work();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return !failed;
+}
+
+Node LoadDocument(const char* input, std::size_t size,
+                  const ParseOptions& options) {
+  const unsigned threads = ThreadCount(options);
+  std::vector<InputRun> runs;
+  NodeType::value type;
+  if (threads > 1 && size >= 2 * MinRunSize &&
+      SplitCollection(input, size, threads, runs, type) && runs.size() > 1) {
+    std::vector<Node> parts(runs.size());
+    auto load = [&](std::size_t i) {
+      const InputRun& run = runs[i];
+      Parser parser(input + run.begin, run.end - run.begin, options,
+                    run.start);
+      NodeBuilder builder, rest;
+      if (parser.HandleNextDocument(builder) &&
+          !parser.HandleNextDocument(rest)) {
+        parts[i] = builder.Root();
+      }
+    };
+
+    // the guess was right if each run is one collection of the root's kind,
+    // and each after the first starts right at its first entry (the first
+    // may open with comments, or with the root's tag or anchor)
+    bool guessed = LoadRuns(runs, threads, load);
+    for (std::size_t i = 0; guessed && i < parts.size(); i++) {
+      guessed = parts[i].Type() == type &&
+                (i == 0 || parts[i].Mark().pos == runs[i].start.pos);
+    }
+
+    if (guessed) {
+      Node root = parts[0];
+      for (std::size_t i = 1; i < parts.size(); i++) {
+        if (type == NodeType::Sequence) {
+          for (const_iterator it = parts[i].begin(); it != parts[i].end();
+               ++it) {
+            root.push_back(*it);
+          }
+        } else {
+          for (const_iterator it = parts[i].begin(); it != parts[i].end();
+               ++it) {
+            root.force_insert(it->first, it->second);
+          }
+        }
+      }
+      return root;
+    }
+  }
+
+  Parser parser(input, size, options);
+  return LoadNextDocument(parser);
+}
+
+std::vector<Node> LoadAllDocuments(const char* input, std::size_t size,
+                                   const ParseOptions& options) {
+  const unsigned threads = ThreadCount(options);
+  std::vector<InputRun> runs;
+  if (threads > 1 && size >= 2 * MinRunSize &&
+      SplitDocuments(input, size, threads, runs) && runs.size() > 1) {
+    std::vector<std::vector<Node>> docs(runs.size());
+    auto load = [&](std::size_t i) {
+      const InputRun& run = runs[i];
+      Parser parser(input + run.begin, run.end - run.begin, options,
+                    run.start);
+      docs[i] = LoadAllDocuments(parser);
+    };
+
+    // a run read on its own may fail differently (an unclosed quote ends the
+    // run rather than meeting a "---" line), so an error is left to be
+    // found by reading the whole input
+    if (LoadRuns(runs, threads, load)) {
+      std::vector<Node> all;
+      for (std::vector<Node>& run : docs) {
+        all.insert(all.end(), run.begin(), run.end());
+      }
+      return all;
+    }
+  }
+
+  Parser parser(input, size, options);
+  return LoadAllDocuments(parser);
+}
+}  // namespace
+
+Node Load(const std::string& input) {
+  Parser parser(input);
+  return LoadNextDocument(parser);
+}
+
+Node Load(const char* input) { return Load(input, std::strlen(input)); }
+
+Node Load(const char* input, std::size_t size) {
+  Parser parser(input, size);
+  return LoadNextDocument(parser);
+}
+
+Node Load(const char* input, std::size_t size, const ParseOptions& options) {
+  return LoadDocument(input, size, options);
 }
 
 Node Load(std::istream& input) {
   Parser parser(input);
-  NodeBuilder builder;
-  if (!parser.HandleNextDocument(builder)) {
-    return Node();
-  }
+  return LoadNextDocument(parser);
+}
 
-  return builder.Root();
+Node Load(std::istream& input, const ParseOptions& options) {
+  Parser parser(input, options);
+  return LoadNextDocument(parser);
 }
 
 Node LoadFile(const std::string& filename) {
+  // Regular files are parsed in place from a read-only mapping
+  MappedFile file(filename);
+  if (file) {
+    Parser parser(file.data(), file.size());
+    return LoadNextDocument(parser);
+  }
+
   std::ifstream fin(filename.c_str());
   if (!fin) {
     throw BadFile();
@@ -42,36 +350,72 @@ Node LoadFile(const std::string& filename) {
   return Load(fin);
 }
 
+Node LoadFile(const std::string& filename, const ParseOptions& options) {
+  MappedFile file(filename);
+  if (file) {
+    return LoadDocument(file.data(), file.size(), options);
+  }
+
+  std::ifstream fin(filename.c_str());
+  if (!fin) {
+    throw BadFile();
+  }
+  return Load(fin, options);
+}
+
 std::vector<Node> LoadAll(const std::string& input) {
-  std::stringstream stream(input);
-  return LoadAll(stream);
+  return LoadAll(input.data(), input.size());
 }
 
 std::vector<Node> LoadAll(const char* input) {
-  std::stringstream stream(input);
-  return LoadAll(stream);
+  return LoadAll(input, std::strlen(input));
 }
 
-std::vector<Node> LoadAll(std::istream& input) {
-  std::vector<Node> docs;
+std::vector<Node> LoadAll(const char* input, std::size_t size) {
+  Parser parser(input, size);
+  return LoadAllDocuments(parser);
+}
 
+std::vector<Node> LoadAll(const char* input, std::size_t size,
+                          const ParseOptions& options) {
+  return LoadAllDocuments(input, size, options);
+}
+
+std::vector<Node> LoadAll(std::istream& input) {
   Parser parser(input);
-  while (1) {
-    NodeBuilder builder;
-    if (!parser.HandleNextDocument(builder)) {
-      break;
-    }
-    docs.push_back(builder.Root());
-  }
+  return LoadAllDocuments(parser);
+}
 
-  return docs;
+std::vector<Node> LoadAll(std::istream& input, const ParseOptions& options) {
+  Parser parser(input, options);
+  return LoadAllDocuments(parser);
 }
 
 std::vector<Node> LoadAllFromFile(const std::string& filename) {
+  MappedFile file(filename);
+  if (file) {
+    Parser parser(file.data(), file.size());
+    return LoadAllDocuments(parser);
+  }
+
   std::ifstream fin(filename.c_str());
   if (!fin) {
     throw BadFile();
   }
   return LoadAll(fin);
 }
+
+std::vector<Node> LoadAllFromFile(const std::string& filename,
+                                  const ParseOptions& options) {
+  MappedFile file(filename);
+  if (file) {
+    return LoadAllDocuments(file.data(), file.size(), options);
+  }
+
+  std::ifstream fin(filename.c_str());
+  if (!fin) {
+    throw BadFile();
+  }
+  return LoadAll(fin, options);
+}
 }  // namespace YAML
@@ -2,19 +2,31 @@
 #include <sstream>
 
 #include "directives.h"  // IWYU pragma: keep
+#include "jsonparser.h"
 #include "scanner.h"     // IWYU pragma: keep
 #include "singledocparser.h"
 #include "token.h"
+#include "yaml-cpp/eventhandler.h"
 #include "yaml-cpp/exceptions.h"  // IWYU pragma: keep
 #include "yaml-cpp/parser.h"
+#include "yaml-cpp/vieweventhandler.h"
 
 namespace YAML {
-class EventHandler;
-
 Parser::Parser() {}
 
 Parser::Parser(std::istream& in) { Load(in); }
+Parser::Parser(std::istream& in, const ParseOptions& options) {
+  Load(in, options);
+}
 Parser::Parser(const std::string& in) { Load(in); }
+Parser::Parser(const char* in, std::size_t size) { Load(in, size); }
+Parser::Parser(const char* in, std::size_t size, const ParseOptions& options) {
+  Load(in, size, options);
+}
+Parser::Parser(const char* in, std::size_t size, const ParseOptions& options,
+               const Mark& start) {
+  Load(in, size, options, start);
+}
 
 Parser::~Parser() {}
 
@@ -22,22 +34,56 @@ Parser::operator bool() const {
   return m_pScanner.get() && !m_pScanner->empty();
 }
 
-void Parser::Load(std::istream& in) {
-  m_pScanner.reset(new Scanner(in));
+void Parser::Load(std::istream& in) { Load(in, ParseOptions()); }
+
+void Parser::Load(std::istream& in, const ParseOptions& options) {
+  // a background reader must stop before another one takes over the stream
+  m_pScanner.reset();
+  m_pScanner.reset(new Scanner(in, options));
   m_pDirectives.reset(new Directives);
+  m_trackMarks = options.trackMarks;
 }
 
 void Parser::Load(const std::string& in) {
   m_pScanner.reset(new Scanner(in));
   m_pDirectives.reset(new Directives);
+  m_trackMarks = true;
+}
+
+void Parser::Load(const char* in, std::size_t size) {
+  Load(in, size, ParseOptions());
+}
+
+void Parser::Load(const char* in, std::size_t size,
+                  const ParseOptions& options) {
+  Load(in, size, options, Mark());
+}
+
+void Parser::Load(const char* in, std::size_t size,
+                  const ParseOptions& options, const Mark& start) {
+  m_pScanner.reset(new Scanner(in, size, options, start));
+  m_pDirectives.reset(new Directives);
+  m_trackMarks = options.trackMarks;
 }
 
 bool Parser::HandleNextDocument(EventHandler& eventHandler) {
+  return HandleDocument(eventHandler);
+}
+
+bool Parser::HandleNextDocument(ViewEventHandler& eventHandler) {
+  return HandleDocument(eventHandler);
+}
+
+template <typename Handler>
+bool Parser::HandleDocument(Handler& eventHandler) {
   if (!m_pScanner.get())
     return false;
 
-  ParseDirectives();
-  if (m_pScanner->empty()) {
+  if (HandleJsonDocument(eventHandler)) {
+    return true;
+  }
+
+  if (!PrepareNextDocument()) {
     return false;
   }
 
@@ -46,6 +92,48 @@ bool Parser::HandleNextDocument(EventHandler& eventHandler) {
   return true;
 }
 
+bool Parser::PrepareNextDocument() {
+  if (!m_pScanner.get())
+    return false;
+
+  ParseDirectives();
+  return !m_pScanner->empty();
+}
+
+template <typename Handler>
+bool Parser::HandleJsonDocument(Handler& eventHandler) {
+  const char* data;
+  std::size_t size;
+  if (!m_pScanner->UnscannedInput(data, size)) {
+    return false;
+  }
+
+  // only worth indexing if the input opens with an object or an array
+  const char* first = data;
+  const char* const end = data + size;
+  while (first != end &&
+         (*first == ' ' || *first == '\t' || *first == '\n' || *first == '\r')) {
+    ++first;
+  }
+  if (first == end || (*first != '{' && *first != '[')) {
+    return false;
+  }
+
+  Mark start = m_pScanner->mark();
+  if (!m_trackMarks) {
+    start = Mark::offset_mark(start.pos);
+  }
+  JsonParser json(data, size, start);
+  if (!json.Parse()) {
+    return false;
+  }
+  json.HandleDocument(eventHandler);
+
+  // that was all of the input
+  m_pScanner.reset();
+  return true;
+}
+
 void Parser::ParseDirectives() {
   bool readDirective = false;
 
@@ -80,7 +168,7 @@ void Parser::HandleDirective(const Token& token) {
 }
 
 void Parser::HandleYamlDirective(const Token& token) {
-  if (!token.params || token.params->size() != 1) {
+  if (token.params.size() != 1) {
     throw ParserException(token.mark, ErrorMsg::YAML_DIRECTIVE_ARGS);
   }
 
@@ -88,13 +176,13 @@ void Parser::HandleYamlDirective(const Token& token) {
     throw ParserException(token.mark, ErrorMsg::REPEATED_YAML_DIRECTIVE);
   }
 
-  std::stringstream str((*token.params)[0]);
+  std::stringstream str(token.params[0]);
   str >> m_pDirectives->version.major;
   str.get();
   str >> m_pDirectives->version.minor;
   if (!str || str.peek() != EOF) {
     throw ParserException(
-      token.mark, std::string(ErrorMsg::YAML_VERSION) + (*token.params)[0]);
+      token.mark, std::string(ErrorMsg::YAML_VERSION) + token.params[0]);
   }
 
   if (m_pDirectives->version.major > 1) {
@@ -106,11 +194,11 @@ void Parser::HandleYamlDirective(const Token& token) {
 }
 
 void Parser::HandleTagDirective(const Token& token) {
-  if (!token.params || token.params->size() != 2)
+  if (token.params.size() != 2)
     throw ParserException(token.mark, ErrorMsg::TAG_DIRECTIVE_ARGS);
 
-  const std::string& handle = (*token.params)[0];
-  const std::string& prefix = (*token.params)[1];
+  const std::string& handle = token.params[0];
+  const std::string& prefix = token.params[1];
   if (m_pDirectives->tags.find(handle) != m_pDirectives->tags.end()) {
     throw ParserException(token.mark, ErrorMsg::REPEATED_TAG_DIRECTIVE);
   }
@@ -118,6 +206,13 @@ void Parser::HandleTagDirective(const Token& token) {
   m_pDirectives->tags[handle] = prefix;
 }
 
+InputStats Parser::GetInputStats() const {
+  if (!m_pScanner.get()) {
+    return InputStats();
+  }
+  return m_pScanner->inputStats();
+}
+
 void Parser::PrintTokens(std::ostream& out) {
   if (!m_pScanner.get()) {
     return;
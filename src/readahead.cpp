@@ -0,0 +1,118 @@
+#include "readahead.h"
+
+#include <chrono>
+
+namespace YAML {
+ReadAhead::ReadAhead(std::streambuf& input, std::size_t blockSize,
+                     std::size_t blockCount)
+    : m_input(input),
+      m_blockSize(blockSize),
+      m_blockCount(blockCount),
+      m_blocks(new unsigned char[blockSize * blockCount]),
+      m_sizes(blockCount, 0),
+      m_ready(0),
+      m_free(blockCount),
+      m_stop(false),
+      m_error(),
+      m_readIndex(0),
+      m_holding(false),
+      m_finished(false),
+      m_stats(),
+      m_thread(&ReadAhead::Run, this) {}
+
+ReadAhead::~ReadAhead() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_freed.notify_one();
+  m_thread.join();
+}
+
+std::size_t ReadAhead::Next(const unsigned char*& block) {
+  if (m_finished) {
+    return 0;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_holding) {
+    m_holding = false;
+    m_free++;
+    m_freed.notify_one();
+  }
+
+  if (m_ready == 0 && !m_error) {
+    auto start = std::chrono::steady_clock::now();
+    m_filled.wait(lock, [this] { return m_ready > 0 || m_error; });
+    auto stalled = std::chrono::steady_clock::now() - start;
+
+    m_stats.stalls++;
+    m_stats.stallNanoseconds += static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stalled).count());
+  }
+
+  // hand out everything read before a failure, then rethrow it
+  if (m_ready == 0) {
+    m_finished = true;
+    std::rethrow_exception(m_error);
+  }
+
+  std::size_t index = m_readIndex;
+  m_readIndex = (m_readIndex + 1) % m_blockCount;
+  m_ready--;
+  m_holding = true;
+
+  std::size_t size = m_sizes[index];
+  if (size == 0) {
+    m_finished = true;
+    return 0;
+  }
+
+  block = m_blocks.get() + index * m_blockSize;
+  m_stats.bytesRead += size;
+  m_stats.blocksRead++;
+  return size;
+}
+
+void ReadAhead::Run() {
+  std::size_t writeIndex = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_freed.wait(lock, [this] { return m_free > 0 || m_stop; });
+      if (m_stop) {
+        return;
+      }
+    }
+
+    // the slot is ours until we publish it, so read without the lock
+    std::size_t size = 0;
+    try {
+      char* block =
+          reinterpret_cast<char*>(m_blocks.get() + writeIndex * m_blockSize);
+      size = static_cast<std::size_t>(
+          m_input.sgetn(block, static_cast<std::streamsize>(m_blockSize)));
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_error = std::current_exception();
+      m_filled.notify_one();
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_sizes[writeIndex] = size;
+      m_free--;
+      m_ready++;
+    }
+    m_filled.notify_one();
+
+    // an empty block marks the end of the input
+    if (size == 0) {
+      return;
+    }
+    writeIndex = (writeIndex + 1) % m_blockCount;
+  }
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include "yaml-cpp/noncopyable.h"
+#include "yaml-cpp/parseoptions.h"
+
+namespace YAML {
+/**
+ * Reads a stream buffer on a helper thread, filling a ring of blocks ahead of
+ * the consumer. Only the helper thread touches the stream buffer until the
+ * end of input has been handed out.
+ */
+class ReadAhead : private noncopyable {
+ public:
+  ReadAhead(std::streambuf& input, std::size_t blockSize,
+            std::size_t blockCount);
+  ~ReadAhead();
+
+  /**
+   * Waits for the next block and points {@code block} at it; the block stays
+   * valid until the next call. Returns 0 once the input is exhausted.
+   *
+   * @throws whatever reading the stream buffer threw on the helper thread.
+   */
+  std::size_t Next(const unsigned char*& block);
+
+  const InputStats& stats() const { return m_stats; }
+
+ private:
+  void Run();
+
+ private:
+  std::streambuf& m_input;
+  const std::size_t m_blockSize;
+  const std::size_t m_blockCount;
+  std::unique_ptr<unsigned char[]> m_blocks;
+  std::vector<std::size_t> m_sizes;
+
+  std::mutex m_mutex;
+  std::condition_variable m_filled;
+  std::condition_variable m_freed;
+
+  // guarded by m_mutex
+  std::size_t m_ready;
+  std::size_t m_free;
+  bool m_stop;
+  std::exception_ptr m_error;
+
+  // used only by the consumer
+  std::size_t m_readIndex;
+  bool m_holding;
+  bool m_finished;
+  InputStats m_stats;
+
+  // started last, once everything it uses is set up
+  std::thread m_thread;
+};
+}
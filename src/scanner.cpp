@@ -7,12 +7,13 @@
 #include "yaml-cpp/exceptions.h"  // IWYU pragma: keep
 
 namespace YAML {
-Scanner::Scanner(std::istream& in)
-    : INPUT(in),
+Scanner::Scanner(std::istream& in, const ParseOptions& options)
+    : INPUT(in, options),
       m_startedStream(false),
       m_endedStream(false),
       m_simpleKeyAllowed(false),
-      m_canBeJSONFlow(false) {
+      m_canBeJSONFlow(false),
+      m_staleSimpleKeys(0) {
   InitTokens();
 }
 
@@ -21,7 +22,19 @@ Scanner::Scanner(const std::string& in)
       m_startedStream(false),
       m_endedStream(false),
       m_simpleKeyAllowed(false),
-      m_canBeJSONFlow(false) {
+      m_canBeJSONFlow(false),
+      m_staleSimpleKeys(0) {
+  InitTokens();
+}
+
+Scanner::Scanner(const char* in, std::size_t size, const ParseOptions& options,
+                 const Mark& start)
+    : INPUT(in, size, options, start),
+      m_startedStream(false),
+      m_endedStream(false),
+      m_simpleKeyAllowed(false),
+      m_canBeJSONFlow(false),
+      m_staleSimpleKeys(0) {
   InitTokens();
 }
 
@@ -29,7 +42,7 @@ Scanner::~Scanner() {}
 
 bool Scanner::empty() {
   EnsureTokensInQueue();
-  return m_tokenOut == m_tokens.end();
+  return m_tokenOut == m_tokenIn;
 }
 
 void Scanner::pop() {
@@ -43,45 +56,42 @@ Token& Scanner::peek() {
 
   // should we be asserting here? I mean, we really
   // just be checking if it's empty before peeking.
-  assert(m_tokenOut != m_tokens.end());
+  assert(m_tokenOut != m_tokenIn);
 
 #if 0
   static Token *pLast = 0;
-  if(pLast != &m_tokens.front())
-    std::cerr << "peek: " << m_tokens.front() << "\n";
-  pLast = &m_tokens.front();
+  if(pLast != &TokenAt(m_tokenOut))
+    std::cerr << "peek: " << TokenAt(m_tokenOut) << "\n";
+  pLast = &TokenAt(m_tokenOut);
 #endif
 
   return peek_unsafe();
 }
 
-void Scanner::CreateToken() {
-  m_tokenIn = m_tokens.emplace_after(m_tokenIn);
+void Scanner::InitTokens() {
+  m_tokens.resize(64);
+  m_tokenMask = m_tokens.size() - 1;
+  m_tokenOut = m_tokenIn = 0;
 }
 
-void Scanner::InitTokens() {
-  m_tokenOut = m_tokens.end();
-  for (int i = 0; i < 64; i++) {
-    m_tokens.emplace_front();
-    if (i == 0) { m_tokenIn = m_tokens.begin(); }
+void Scanner::GrowTokens() {
+  // unresolved simple keys can hold any number of tokens back; move the
+  // queue, in order, into a ring twice the size
+  std::vector<Token> tokens(m_tokens.size() * 2);
+  const std::size_t mask = tokens.size() - 1;
+  for (std::size_t i = m_tokenOut; i != m_tokenIn; i++) {
+    tokens[i & mask] = std::move(TokenAt(i));
   }
-
-  // auto prev = m_tokens.begin();
-  // auto it = m_tokens.begin();
-  // ++it;
-  // for (; it != m_tokens.end(); it++) {
-  //   printf("%li ", (std::ptrdiff_t(&(*it)) - std::ptrdiff_t(&(*prev))));
-  //   prev = it;
-  // }
-  // printf("\n -- %lu / %lu\n", sizeof(Token), alignof(Token));
+  m_tokens.swap(tokens);
+  m_tokenMask = mask;
 }
 
 Mark Scanner::mark() const { return INPUT.mark(); }
 
 void Scanner::EnsureTokensInQueue() {
   while (1) {
-    if (m_tokenOut != m_tokens.end()) {
-      Token& token = *m_tokenOut;
+    if (m_tokenOut != m_tokenIn) {
+      Token& token = TokenAt(m_tokenOut);
       m_tokenPtr = &token;
 
       // if this guy's valid, then we're done
@@ -122,6 +132,9 @@ void Scanner::ScanNextToken() {
   // get rid of whitespace, etc. (in between tokens it should be irrelevent)
   ScanToNextToken();
 
+  // let go of simple keys that we've scanned too far past
+  InvalidateStaleSimpleKeys();
+
   // maybe need to end some blocks
   PopIndentToHere();
 
@@ -215,12 +228,14 @@ void Scanner::ScanToNextToken() {
   while (1) {
     INPUT.EatSpace();
 
-    // first eat whitespace
+    // first eat whitespace; spaces go a run at a time, but we need to see
+    // each tab
     while (INPUT && IsWhitespaceToBeEaten(INPUT.peek())) {
       if (InBlockContext() && Exp::Tab::Matches(INPUT)) {
         m_simpleKeyAllowed = false;
       }
       INPUT.eat();
+      INPUT.EatSpace();
     }
 
     // then eat a comment
@@ -332,7 +347,7 @@ Scanner::IndentMarker* Scanner::PushIndentTo(int column,
   auto& token = push();
   token.type = GetStartTokenFor(type);
   token.mark = INPUT.mark();
-  indent.pStartToken = &token;
+  indent.startToken = m_tokenIn - 1;
 
   // and then the indent
   m_indents.push(&indent);
@@ -404,8 +419,8 @@ void Scanner::PopIndent() {
 
 void Scanner::ThrowParserException(const std::string& msg) const {
   Mark mark = Mark::null_mark();
-  if (m_tokenOut != m_tokens.end()) {
-    const Token& token = *m_tokenOut;
+  if (m_tokenOut != m_tokenIn) {
+    const Token& token = TokenAt(m_tokenOut);
     mark = token.mark;
   }
   throw ParserException(mark, msg);
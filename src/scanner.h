@@ -9,14 +9,13 @@
 #include <stack>
 #include <string>
 #include <list>
-#include <forward_list>
+#include <vector>
 
 #include "scanscalar.h"
 #include "stream.h"
 #include "token.h"
 #include "yaml-cpp/mark.h"
 #include "exp.h"
-#include "plalloc.h"
 
 namespace YAML {
 class Node;
@@ -27,8 +26,12 @@ class RegEx;
  */
 class Scanner {
  public:
-  explicit Scanner(std::istream &in);
+  explicit Scanner(std::istream &in,
+                   const ParseOptions &options = ParseOptions());
   explicit Scanner(const std::string &in);
+  Scanner(const char *in, std::size_t size,
+          const ParseOptions &options = ParseOptions(),
+          const Mark &start = Mark());
   ~Scanner();
 
   /** Returns true if there are no more tokens to be read. */
@@ -42,21 +45,13 @@ class Scanner {
   }
 
   Token& push() {
-    if (m_tokenOut != m_tokens.begin()) {
-      // Move free token to the end
-      auto last = m_tokens.begin();
-      m_tokens.splice_after(m_tokenIn, m_tokens, m_tokens.before_begin());
-      m_tokenIn = last;
-    } else {
-      // Full
-      CreateToken();
+    if (m_tokenIn - m_tokenOut == m_tokens.size()) {
+      GrowTokens();
     }
-    if (m_tokenOut == m_tokens.end()) {
-      m_tokenOut = m_tokenIn;
-    }
-
-    m_tokenIn->status = Token::VALID;
-    return *m_tokenIn;
+    Token& token = m_tokens[m_tokenIn++ & m_tokenMask];
+    token.status = Token::VALID;
+    token.view.str = nullptr;
+    return token;
   }
 
   /** Returns, but does not remove, the next token in the queue. */
@@ -69,17 +64,33 @@ class Scanner {
   /** Returns the current mark in the input stream. */
   Mark mark() const;
 
+  /** Returns the counters of the underlying istream reader. */
+  const InputStats &inputStats() const { return INPUT.stats(); }
+
+  /**
+   * Gives all of the input, if it is held in one contiguous buffer and no
+   * token has been scanned from it yet; otherwise returns false.
+   */
+  bool UnscannedInput(const char *&data, std::size_t &size) const {
+    if (m_startedStream || !INPUT.contiguous()) {
+      return false;
+    }
+    data = INPUT.data();
+    size = INPUT.available();
+    return true;
+  }
+
  private:
   struct IndentMarker {
     enum INDENT_TYPE { MAP, SEQ, NONE };
     enum STATUS { VALID, INVALID, UNKNOWN };
     IndentMarker(int column_, INDENT_TYPE type_)
-        : column(column_), type(type_), status(VALID), pStartToken(nullptr) {}
+        : column(column_), type(type_), status(VALID), startToken(NoToken) {}
 
     int column;
     INDENT_TYPE type;
     STATUS status;
-    Token *pStartToken;
+    std::size_t startToken;
   };
 
   enum FLOW_MARKER { FLOW_MAP, FLOW_SEQ };
@@ -150,7 +161,9 @@ class Scanner {
   void InsertPotentialSimpleKey();
   void InvalidateSimpleKey();
   bool VerifySimpleKey();
+  void PopSimpleKey();
   void PopAllSimpleKeys();
+  void InvalidateStaleSimpleKeys();
 
   /**
    * Throws a ParserException with the current token location (if available),
@@ -162,16 +175,16 @@ class Scanner {
 
 
   struct SimpleKey {
-    SimpleKey(const Mark &mark_, std::size_t flowLevel_);
+    SimpleKey(int markPos_, int markLine_, std::size_t flowLevel_);
 
-    void Validate();
-    void Invalidate();
+    void Validate(Scanner &scanner);
+    void Invalidate(Scanner &scanner);
 
     int markPos;
     int markLine;
     std::size_t flowLevel;
     IndentMarker *pIndent;
-    Token *pMapStart, *pKey;
+    std::size_t mapStart, key;
   };
 
   // and the tokens
@@ -195,36 +208,50 @@ class Scanner {
 
   // scanscalar.cpp
   std::string ScanScalar(ScanScalarParams& info);
+  bool ScanBorrowedScalar(ScanScalarParams& info, detail::string_view& view);
   static int MatchScalarEmpty(Exp::Source<4> in);
   static int MatchScalarSingleQuoted(Exp::Source<4> in);
   static int MatchScalarDoubleQuoted(Exp::Source<4> in);
   static int MatchScalarEnd(Exp::Source<4> in);
   static int MatchScalarEndInFlow(Exp::Source<4> in);
   static int MatchScalarIndent(Exp::Source<4> in);
+  static const char *SpanPlainScalar(const char *begin, const char *end);
+  static const char *SpanPlainScalarInFlow(const char *begin, const char *end);
+  static const char *SpanSingleQuoted(const char *begin, const char *end);
+  static const char *SpanDoubleQuoted(const char *begin, const char *end);
+  static const char *SpanBlockScalar(const char *begin, const char *end);
 
  private:
 
-  void CreateToken();
+  // tokens are named by their position in the whole token stream; this
+  // stays valid when the queue grows
+  static const std::size_t NoToken = static_cast<std::size_t>(-1);
+
+  Token &TokenAt(std::size_t index) { return m_tokens[index & m_tokenMask]; }
+  const Token &TokenAt(std::size_t index) const {
+    return m_tokens[index & m_tokenMask];
+  }
   void InitTokens();
+  void GrowTokens();
 
   // the stream
   Stream INPUT;
 
-  // the output (tokens)
-  template<typename T>
-  using token_alloc = plalloc<T, 64>;
-
-  std::forward_list<Token, token_alloc<Token>> m_tokens;
-  //std::forward_list<Token> m_tokens;
-  std::forward_list<Token>::iterator m_tokenOut;
-  std::forward_list<Token>::iterator m_tokenIn;
+  // the output (tokens): a ring of a power-of-two size, holding the tokens
+  // from m_tokenOut (the next to be read) up to m_tokenIn (the next to be
+  // written). Slots are reused, along with their strings' capacity.
+  std::vector<Token> m_tokens;
+  std::size_t m_tokenMask;
+  std::size_t m_tokenOut;
+  std::size_t m_tokenIn;
   Token* m_tokenPtr = nullptr;
 
   // state info
   bool m_startedStream, m_endedStream;
   bool m_simpleKeyAllowed;
   bool m_canBeJSONFlow;
-  std::stack<SimpleKey,std::vector<SimpleKey>> m_simpleKeys;
+  std::vector<SimpleKey> m_simpleKeys;  // used as a stack
+  std::size_t m_staleSimpleKeys;       // the bottom ones, already invalid
   std::stack<IndentMarker *,std::vector<IndentMarker *>> m_indents;
   std::deque<IndentMarker> m_indentRefs;  // for "garbage collection"
   std::stack<FLOW_MARKER, std::vector<FLOW_MARKER>> m_flows;
@@ -1,7 +1,9 @@
 #include "scanner.h"
 
 #include <algorithm>
+#include <limits>
 
+#include "charsearch.h"
 #include "exp.h"
 #include "stream.h"
 #include "yaml-cpp/exceptions.h"  // IWYU pragma: keep
@@ -28,9 +30,9 @@ int Scanner::MatchScalarEnd(Exp::Source<4> in) {
   using namespace Exp;
   using ScalarEnd = Matcher<
       OR < SEQ < Char<':'>,
-                 OR < detail::BlankOrBreak, Empty>>,
-           SEQ < detail::BlankOrBreak,
-                 detail::Comment>>>;
+                 OR < Exp::detail::BlankOrBreak, Empty>>,
+           SEQ < Exp::detail::BlankOrBreak,
+                 Exp::detail::Comment>>>;
 
   return ScalarEnd::Match(in);
 }
@@ -39,11 +41,11 @@ int Scanner::MatchScalarEndInFlow(Exp::Source<4> in) {
   using namespace Exp;
   using ScalarEndInFlow = Matcher <
       OR < SEQ < Char<':'>,
-                 OR < detail::Blank,
+                 OR < Exp::detail::Blank,
                       Char<','>,
                       Char<']'>,
                       Char<'}'>,
-                      detail::Break,
+                      Exp::detail::Break,
                       Empty >>,
            Char<','>,
            Char<'?'>,
@@ -51,8 +53,8 @@ int Scanner::MatchScalarEndInFlow(Exp::Source<4> in) {
            Char<']'>,
            Char<'{'>,
            Char<'}'>,
-           SEQ < detail::BlankOrBreak,
-                 detail::Comment>>>;
+           SEQ < Exp::detail::BlankOrBreak,
+                 Exp::detail::Comment>>>;
 
    return ScalarEndInFlow::Match(in);
 }
@@ -60,15 +62,56 @@ int Scanner::MatchScalarEndInFlow(Exp::Source<4> in) {
 int Scanner::MatchScalarIndent(Exp::Source<4> in) {
   using namespace Exp;
   using ScalarEndInFlow = Matcher <
-      SEQ < detail::Blank,
-            detail::Comment>>;
+      SEQ < Exp::detail::Blank,
+            Exp::detail::Comment>>;
 
   return ScalarEndInFlow::Match(in);
 }
 
+// A plain scalar can only end at ':', or at a blank before '#'; the latter
+// is left for the character-wise scan, which ends the scalar at that blank.
+// NUL is the plain scalar's (non-)escape character.
+const char* Scanner::SpanPlainScalar(const char* begin, const char* end) {
+  const char* stop =
+      CharSearch::FindAny<':', '#', '\n', '\r', '\0', Stream::eof()>(begin,
+                                                                        end);
+  if (stop != end && *stop == '#' && stop != begin) {
+    --stop;
+  }
+  return stop;
+}
+
+const char* Scanner::SpanPlainScalarInFlow(const char* begin,
+                                           const char* end) {
+  const char* stop =
+      CharSearch::FindAny<':', '#', ',', '?', '[', ']', '{', '}', '\n', '\r',
+                          '\0', Stream::eof()>(begin, end);
+  if (stop != end && *stop == '#' && stop != begin) {
+    --stop;
+  }
+  return stop;
+}
+
+// Inside quotes only the quote, the escape character and line breaks (for
+// folding) need a closer look; for single quotes the quote is the escape.
+const char* Scanner::SpanSingleQuoted(const char* begin, const char* end) {
+  return CharSearch::FindAny<'\'', '\n', '\r', Stream::eof()>(begin, end);
+}
+
+const char* Scanner::SpanDoubleQuoted(const char* begin, const char* end) {
+  return CharSearch::FindAny<'\"', '\\', '\n', '\r', Stream::eof()>(begin,
+                                                                    end);
+}
+
+// Block scalar content runs to the end of the line; NUL is its
+// (non-)escape character.
+const char* Scanner::SpanBlockScalar(const char* begin, const char* end) {
+  return CharSearch::FindAny<'\n', '\r', '\0', Stream::eof()>(begin, end);
+}
+
 static bool MatchDocIndicator(const Stream& in) {
  using namespace Exp;
- using DocIndicator = Matcher<OR <detail::DocStart, detail::DocEnd>>;
+ using DocIndicator = Matcher<OR <Exp::detail::DocStart, Exp::detail::DocEnd>>;
 
  return DocIndicator::Matches(in);
 }
@@ -207,6 +250,11 @@ std::string Scanner::ScanScalar(ScanScalarParams& params) {
       params.leadingSpaces = true;
       break;
     }
+
+    // likewise if the input ends right after a line break
+    if (!INPUT && params.eatEnd) {
+      throw ParserException(INPUT.mark(), ErrorMsg::EOF_IN_SCALAR);
+    }
   }
 
   PostProcess(scalar, params, r.lastEscapedChar);
@@ -214,6 +262,85 @@ std::string Scanner::ScanScalar(ScanScalarParams& params) {
   return scalar;
 }
 
+// The lookahead the stream would give at 'at'.
+static Exp::Source<4> SourceAt(const char* at, const char* end) {
+  Exp::Source<4> source;
+  for (std::size_t i = 0; i < source.size(); i++) {
+    source[i] = (i < static_cast<std::size_t>(end - at)) ? at[i] : Stream::eof();
+  }
+  return source;
+}
+
+// ScanBorrowedScalar
+// . Most scalars are a single run of the input that ends on the line it
+//   started on and needs no unescaping or folding. When the input is
+//   contiguous, such a scalar is returned as a view of it instead of a copy.
+//
+// . Anything else returns false without having eaten anything, and is left
+//   to ScanScalar. Otherwise the input is left just as ScanScalar would
+//   have left it.
+bool Scanner::ScanBorrowedScalar(ScanScalarParams& params,
+                                 detail::string_view& view) {
+  if (!INPUT.contiguous() || !params.spanFn) {
+    return false;
+  }
+
+  const char* begin = INPUT.data();
+  const char* end = begin + INPUT.available();
+  const char* stop = params.spanFn(begin, end);
+
+  int endMatch = 0;
+  bool endsLine = false;
+  if (stop == end) {
+    if (params.eatEnd) {
+      return false;
+    }
+  } else if (*stop == '\n' || (*stop == '\r' && stop + 1 != end &&
+                               stop[1] == '\n')) {
+    // the scalar only ends here if the next line is less indented (and not
+    // empty, which would start folding)
+    if (params.eatEnd) {
+      return false;
+    }
+    const char* next = stop + (*stop == '\r' ? 2 : 1);
+    const char* content = CharSearch::SkipAny<' '>(next, end);
+    if (content - next >= params.indent ||
+        (content != end && (*content == '\t' || *content == '\n' ||
+                            *content == '\r'))) {
+      return false;
+    }
+    endsLine = true;
+  } else if ((endMatch = params.end(SourceAt(stop, end))) < 0) {
+    return false;
+  }
+
+  // trailing spaces go; so do tabs, at the end of a line
+  const char* last = stop;
+  if (params.trimTrailingSpaces) {
+    while (last != begin &&
+           (last[-1] == ' ' || (endsLine && last[-1] == '\t'))) {
+      --last;
+    }
+  }
+  view.str = begin;
+  view.length = last - begin;
+
+  params.leadingSpaces = false;
+  INPUT.EatInLine(stop - begin);
+  if (params.eatEnd) {
+    INPUT.eat(endMatch);
+  }
+  if (endsLine) {
+    INPUT.EatLineBreak();
+    EatToIndentation(INPUT, params, false);
+    if (INPUT.peek() == ' ' || INPUT.peek() == '\t') {
+      EatAfterIndentation(INPUT, params);
+    }
+    params.leadingSpaces = true;
+  }
+  return true;
+}
+
 
 TEST_NO_INLINE
 static void ScanLine(Stream& INPUT, const ScanScalarParams& params,
@@ -229,6 +356,34 @@ static void ScanLine(Stream& INPUT, const ScanScalarParams& params,
 
   while (INPUT) {
 
+    // copy a run of characters that need no checks at once; the first
+    // character of a line is always checked (for document indicators)
+    if (params.spanFn && INPUT.column() > 0) {
+      const char* begin = INPUT.data();
+      const char* stop = params.spanFn(begin, begin + INPUT.available());
+      if (stop != begin) {
+        std::size_t count = stop - begin;
+        if (bufferFill > 0) {
+          scalar.insert(scalar.size(), buffer, bufferFill);
+          bufferFill = 0;
+        }
+        scalar.append(begin, count);
+        scalarLength += count;
+
+        const char* last = stop;
+        while (last != begin && (last[-1] == ' ' || last[-1] == '\t')) {
+          --last;
+        }
+        if (last != begin) {
+          out.lastNonWhitespaceChar = scalarLength - (stop - last);
+        }
+
+        out.foundNonEmptyLine = true;
+        INPUT.EatInLine(count);
+        continue;
+      }
+    }
+
     Exp::Source<4> input;
     INPUT.LookaheadBuffer(input);
 
@@ -300,15 +455,30 @@ static void ScanLine(Stream& INPUT, const ScanScalarParams& params,
   }
 }
 
+// Returns the length of the run of Cs at the current position, and the
+// character after it (Stream::eof() at the end of the input).
+template <char... Cs>
+static std::size_t CountRun(Stream& INPUT, char& next) {
+  std::size_t count = 0;
+  while (true) {
+    std::size_t available = INPUT.Prefetch(count + 1);
+    const char* begin = INPUT.data();
+    count = CharSearch::SkipAny<Cs...>(begin + count, begin + available) -
+            begin;
+    if (count < available) {
+      next = begin[count];
+      return count;
+    }
+    if (available < count + 1) {
+      next = Stream::eof();
+      return count;
+    }
+  }
+}
+
 TEST_NO_INLINE
 static void EatToIndentation(Stream& INPUT, ScanScalarParams& params, bool foundEmptyLine) {
 
-  using namespace Exp;
-
-  using _ = Char<' '>;
-
-  using SpaceInvaders = Matcher<Count<_,_,_,_,_,_,_,_>>;
-
   // first the required indentation
   // This can be:
   // - BlockScalar (detectIndent/colum<indent)
@@ -318,37 +488,37 @@ static void EatToIndentation(Stream& INPUT, ScanScalarParams& params, bool found
     max = std::numeric_limits<int>::max();
   }
 
-  // Don't eat the whitespace before comments
-  while (max > 0) {
-
-    auto input = INPUT.GetLookaheadBuffer(8);
-
-    int pos = SpaceInvaders::Match(input);
-
-    // No, nothing to eat!
-    if (pos == 0) { break; }
-
-    // Pos can be up to 8. Dont eat before potential comment.
-    if (params.indentFn && (pos == 8 || input[pos] == '#')) {
-      pos -= 1;
-    }
-    if (max < pos) { pos = max; }
+  if (max <= 0 || INPUT.peek() != ' ') {
+    return;
+  }
 
-    // Eat spaces
-    for (int i = 0; i < pos; i++) {
-      INPUT.eat();
-    }
+  char next;
+  std::size_t count = CountRun<' '>(INPUT, next);
 
-    if (pos < 7 || input[7] != ' ') {
-      break;
-    }
-    max -= pos;
+  // Don't eat the whitespace before comments
+  if (params.indentFn && next == '#') {
+    count--;
   }
+  INPUT.EatInLine(std::min<std::size_t>(count, max));
 }
 
 TEST_NO_INLINE
 static void EatAfterIndentation(Stream& INPUT, ScanScalarParams& params) {
 
+  // past the indentation a tab is just whitespace, so a whole run of blanks
+  // can go at once (but not the one before a comment)
+  if (params.eatLeadingWhitespace &&
+      (INPUT.column() >= params.indent ||
+       params.onTabInIndentation != THROW)) {
+    char next;
+    std::size_t count = CountRun<' ', '\t'>(INPUT, next);
+    if (params.indentFn && next == '#') {
+      count--;
+    }
+    INPUT.EatInLine(count);
+    return;
+  }
+
   for (char c = INPUT.peek(); (c == ' ' || c == '\t'); c = INPUT.peek()) {
     // we check for tabs that masquerade as indentation
     if (c == '\t' && INPUT.column() < params.indent &&
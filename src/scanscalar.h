@@ -14,6 +14,7 @@ struct ScanScalarParams {
   ScanScalarParams()
     :   end(nullptr),
         indentFn(nullptr),
+        spanFn(nullptr),
         eatEnd(false),
         indent(0),
         detectIndent(false),
@@ -30,6 +31,10 @@ struct ScanScalarParams {
   //std::function<int(const Stream& in)> end;   // what condition ends this scalar?
   int (*end)(Exp::Source<4> in);   // what condition ends this scalar?
   int (*indentFn)(Exp::Source<4> in);   // what condition ends this scalar?
+  // where does the run of plain content starting at 'begin' end? (i.e. the
+  // first character that could end the scalar or needs escaping, line
+  // breaks included; nullptr to go one character at a time)
+  const char* (*spanFn)(const char* begin, const char* end);
 
   bool eatEnd;        // should we eat that condition when we see it?
   int indent;         // what level of indentation should be eaten and ignored?
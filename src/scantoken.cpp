@@ -1,5 +1,6 @@
 #include <sstream>
 
+#include "charsearch.h"
 #include "exp.h"
 #include "scanner.h"
 #include "scanscalar.h"
@@ -33,7 +34,8 @@ void Scanner::ScanDirective() {
 
   INPUT.eat();
 
-  // read name
+  // read name (into a recycled token, so clear it first)
+  token.value.clear();
   while (INPUT && !Exp::BlankOrBreak::Matches(INPUT))
     token.value += INPUT.get();
 
@@ -252,12 +254,31 @@ void Scanner::ScanAnchorOrAlias() {
   char indicator = INPUT.get();
   alias = (indicator == Keys::Alias);
 
-  // now eat the content
-  while (INPUT && Exp::Anchor::Matches(INPUT))
-    name += INPUT.get();
+  // now eat the content; when the input is contiguous, the name is left
+  // where it is and the token refers to it
+  detail::string_view view{nullptr, 0};
+  if (INPUT.contiguous()) {
+    const char* begin = INPUT.data();
+    const char* end = begin + INPUT.available();
+    const char* stop = begin;
+    while (true) {
+      stop = CharSearch::FindAny<'[', ']', '{', '}', ',', ' ', '\t', '\n', '\r',
+                                 '\x04'>(stop, end);
+      // a lone '\r' isn't a break
+      if (stop == end || *stop != '\r' || (stop + 1 != end && stop[1] == '\n'))
+        break;
+      ++stop;
+    }
+    view = detail::string_view{begin, static_cast<std::size_t>(stop - begin)};
+    INPUT.EatInLine(view.length);
+  } else {
+    while (INPUT && Exp::Anchor::Matches(INPUT))
+      name += INPUT.get();
+    view = detail::string_view{name.data(), name.size()};
+  }
 
   // we need to have read SOMETHING!
-  if (name.empty())
+  if (view.length == 0)
     throw ParserException(INPUT.mark(), alias ? ErrorMsg::ALIAS_NOT_FOUND
                                               : ErrorMsg::ANCHOR_NOT_FOUND);
 
@@ -270,7 +291,10 @@ void Scanner::ScanAnchorOrAlias() {
   auto& token = push();
   token.type = alias ? Token::ALIAS : Token::ANCHOR;
   token.mark = mark;
-  token.value = std::move(name);
+  if (INPUT.contiguous())
+    token.view = view;
+  else
+    token.value = std::move(name);
 }
 
 // Tag
@@ -321,10 +345,12 @@ void Scanner::ScanPlainScalar() {
   ScanScalarParams params;
   if (InFlowContext()) {
       params.end = MatchScalarEndInFlow;
+      params.spanFn = SpanPlainScalarInFlow;
       params.indent = 0;
       params.indentFn = MatchScalarIndent;
   } else {
       params.end = MatchScalarEnd;
+      params.spanFn = SpanPlainScalar;
       params.indent = GetTopIndent() + 1;
       params.indentFn = MatchScalarIndent;
   }
@@ -343,7 +369,9 @@ void Scanner::ScanPlainScalar() {
   auto& token = push();
   token.type = Token::PLAIN_SCALAR;
   token.mark = INPUT.mark();
-  token.value = ScanScalar(params);
+  if (!ScanBorrowedScalar(params, token.view)) {
+    token.value = ScanScalar(params);
+  }
 
   // can have a simple key only if we ended the scalar by starting a new line
   m_simpleKeyAllowed = params.leadingSpaces;
@@ -366,8 +394,10 @@ void Scanner::ScanQuotedScalar() {
   ScanScalarParams params;
   if (single) {
       params.end = MatchScalarSingleQuoted;
+      params.spanFn = SpanSingleQuoted;
   } else {
       params.end = MatchScalarDoubleQuoted;
+      params.spanFn = SpanDoubleQuoted;
   }
 
   params.eatEnd = true;
@@ -391,7 +421,9 @@ void Scanner::ScanQuotedScalar() {
   INPUT.eat();
 
   // and scan
-  token.value = ScanScalar(params);
+  if (!ScanBorrowedScalar(params, token.view)) {
+    token.value = ScanScalar(params);
+  }
 
   m_simpleKeyAllowed = false;
   m_canBeJSONFlow = true;
@@ -411,6 +443,7 @@ void Scanner::ScanBlockScalar() {
   params.detectIndent = true;
 
   params.end = MatchScalarEmpty;
+  params.spanFn = SpanBlockScalar;
 
   // eat block indicator ('|' or '>')
   Mark mark = INPUT.mark();
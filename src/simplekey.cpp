@@ -4,31 +4,32 @@
 namespace YAML {
 struct Mark;
 
-Scanner::SimpleKey::SimpleKey(const Mark& mark_, std::size_t flowLevel_)
-    : markPos(mark_.pos),
-      markLine(mark_.line),
+Scanner::SimpleKey::SimpleKey(int markPos_, int markLine_,
+                              std::size_t flowLevel_)
+    : markPos(markPos_),
+      markLine(markLine_),
       flowLevel(flowLevel_),
-      pIndent(nullptr), pMapStart(nullptr), pKey(nullptr) {}
+      pIndent(nullptr), mapStart(NoToken), key(NoToken) {}
 
-void Scanner::SimpleKey::Validate() {
+void Scanner::SimpleKey::Validate(Scanner& scanner) {
   // Note: pIndent will *not* be garbage here;
   //       we "garbage collect" them so we can
   //       always refer to them
   if (pIndent)
     pIndent->status = IndentMarker::VALID;
-  if (pMapStart)
-    pMapStart->status = Token::VALID;
-  if (pKey)
-    pKey->status = Token::VALID;
+  if (mapStart != NoToken)
+    scanner.TokenAt(mapStart).status = Token::VALID;
+  if (key != NoToken)
+    scanner.TokenAt(key).status = Token::VALID;
 }
 
-void Scanner::SimpleKey::Invalidate() {
+void Scanner::SimpleKey::Invalidate(Scanner& scanner) {
   if (pIndent)
     pIndent->status = IndentMarker::INVALID;
-  if (pMapStart)
-    pMapStart->status = Token::INVALID;
-  if (pKey)
-    pKey->status = Token::INVALID;
+  if (mapStart != NoToken)
+    scanner.TokenAt(mapStart).status = Token::INVALID;
+  if (key != NoToken)
+    scanner.TokenAt(key).status = Token::INVALID;
 }
 
 // CanInsertPotentialSimpleKey
@@ -45,7 +46,7 @@ bool Scanner::CanInsertPotentialSimpleKey() const {
 // start token)
 bool Scanner::ExistsActiveSimpleKey() const {
   if (__builtin_expect(!m_simpleKeys.empty(), 1)) {
-    return m_simpleKeys.top().flowLevel == GetFlowLevel();
+    return m_simpleKeys.back().flowLevel == GetFlowLevel();
   }
   return false;
 }
@@ -55,16 +56,16 @@ bool Scanner::ExistsActiveSimpleKey() const {
 //   and save it on a stack.
 void Scanner::InsertPotentialSimpleKey() {
   if (CanInsertPotentialSimpleKey()) {
-    m_simpleKeys.emplace(INPUT.mark(), GetFlowLevel());
-    SimpleKey& key = m_simpleKeys.top();
+    m_simpleKeys.emplace_back(INPUT.pos(), INPUT.line(), GetFlowLevel());
+    SimpleKey& key = m_simpleKeys.back();
 
     // first add a map start, if necessary
     if (InBlockContext()) {
       key.pIndent = PushIndentTo(INPUT.column(), IndentMarker::MAP);
       if (key.pIndent) {
         key.pIndent->status = IndentMarker::UNKNOWN;
-        key.pMapStart = key.pIndent->pStartToken;
-        key.pMapStart->status = Token::UNVERIFIED;
+        key.mapStart = key.pIndent->startToken;
+        TokenAt(key.mapStart).status = Token::UNVERIFIED;
       }
     }
 
@@ -73,7 +74,7 @@ void Scanner::InsertPotentialSimpleKey() {
     token.type = Token::KEY;
     token.mark = INPUT.mark();
     token.status = Token::UNVERIFIED;
-    key.pKey = &token;
+    key.key = m_tokenIn - 1;
   }
 }
 
@@ -84,12 +85,12 @@ void Scanner::InvalidateSimpleKey() {
     return;
 
   // grab top key
-  SimpleKey& key = m_simpleKeys.top();
+  SimpleKey& key = m_simpleKeys.back();
   if (key.flowLevel != GetFlowLevel())
     return;
 
-  key.Invalidate();
-  m_simpleKeys.pop();
+  key.Invalidate(*this);
+  PopSimpleKey();
 }
 
 // VerifySimpleKey
@@ -100,13 +101,13 @@ bool Scanner::VerifySimpleKey() {
     return false;
 
   // grab top key
-  SimpleKey key = m_simpleKeys.top();
+  SimpleKey key = m_simpleKeys.back();
 
   // only validate if we're in the correct flow level
   if (key.flowLevel != GetFlowLevel())
     return false;
 
-  m_simpleKeys.pop();
+  PopSimpleKey();
 
   bool isValid = true;
 
@@ -116,15 +117,42 @@ bool Scanner::VerifySimpleKey() {
 
   // invalidate key
   if (isValid)
-    key.Validate();
+    key.Validate(*this);
   else
-    key.Invalidate();
+    key.Invalidate(*this);
 
   return isValid;
 }
 
+void Scanner::PopSimpleKey() {
+  m_simpleKeys.pop_back();
+  if (m_staleSimpleKeys > m_simpleKeys.size())
+    m_staleSimpleKeys = m_simpleKeys.size();
+}
+
 void Scanner::PopAllSimpleKeys() {
-  while (!m_simpleKeys.empty())
-    m_simpleKeys.pop();
+  m_simpleKeys.clear();
+  m_staleSimpleKeys = 0;
+}
+
+// InvalidateStaleSimpleKeys
+// . A simple key has to end on its own line, within 1024 characters, so once
+//   we're past that it can never be verified. When such a key waits below the
+//   flow collection we're in, it could hold back every token in it; so
+//   invalidate its tokens now, and leave the key itself to be resolved (to
+//   the same end) as usual.
+// . Keys are stacked in input order, so the stale ones are at the bottom.
+void Scanner::InvalidateStaleSimpleKeys() {
+  for (; m_staleSimpleKeys < m_simpleKeys.size(); m_staleSimpleKeys++) {
+    SimpleKey& key = m_simpleKeys[m_staleSimpleKeys];
+    if (key.flowLevel == GetFlowLevel() ||
+        (INPUT.line() == key.markLine && INPUT.pos() - key.markPos <= 1024))
+      break;
+
+    // its tokens may now be read, and their slots reused
+    key.Invalidate(*this);
+    key.pIndent = nullptr;
+    key.mapStart = key.key = NoToken;
+  }
 }
 }
@@ -3,6 +3,7 @@
 #include <sstream>
 
 #include "collectionstack.h"  // IWYU pragma: keep
+#include "handlerstrings.h"
 #include "scanner.h"
 #include "singledocparser.h"
 #include "tag.h"
@@ -12,41 +13,128 @@
 #include "yaml-cpp/exceptions.h"  // IWYU pragma: keep
 #include "yaml-cpp/mark.h"
 #include "yaml-cpp/null.h"
+#include "yaml-cpp/vieweventhandler.h"
 
 namespace YAML {
 SingleDocParser::SingleDocParser(Scanner& scanner, const Directives& directives)
     : m_scanner(scanner),
       m_directives(directives),
       m_pCollectionStack(new CollectionStack),
-      m_curAnchor(0) {}
+      m_frames(),
+      m_curAnchor(0) {
+  PushFrame(Frame::DOCUMENT_START);
+}
 
 SingleDocParser::~SingleDocParser() {}
 
 // HandleDocument
 // . Handles the next document
 // . Throws a ParserException on error.
-void SingleDocParser::HandleDocument(EventHandler& eventHandler) {
-  assert(!m_scanner.empty());  // guaranteed that there are tokens
-  assert(!m_curAnchor);
+template <typename Handler>
+void SingleDocParser::HandleDocument(Handler& eventHandler) {
+  while (HandleStep(eventHandler)) {
+  }
+}
 
-  const Token& token = m_scanner.peek_unsafe();
-  eventHandler.OnDocumentStart(token.mark);
+// HandleStep
+// . Takes the step that the innermost open frame is waiting on. Each frame
+//   stands for a loop (or a call) of a recursive descent parser, and its
+//   state for where in that loop it is.
+template <typename Handler>
+bool SingleDocParser::HandleStep(Handler& eventHandler) {
+  assert(!m_frames.empty());
 
-  // eat doc start
-  if (token.type == Token::DOC_START)
-    m_scanner.pop();
+  Frame& frame = m_frames.back();
+  switch (frame.state) {
+    case Frame::DOCUMENT_START: {
+      assert(!m_scanner.empty());  // guaranteed that there are tokens
+      assert(!m_curAnchor);
 
-  // recurse!
-  HandleNode(eventHandler);
+      const Token& token = m_scanner.peek_unsafe();
+      eventHandler.OnDocumentStart(token.mark);
+      frame.mark = token.mark;
 
-  eventHandler.OnDocumentEnd();
+      // eat doc start
+      if (token.type == Token::DOC_START)
+        m_scanner.pop();
 
-  // and finally eat any doc ends we see
-  while (!m_scanner.empty() && m_scanner.peek_unsafe().type == Token::DOC_END)
-    m_scanner.pop_unsafe();
+      // recurse!
+      frame.state = Frame::DOCUMENT_END;
+      PushFrame(Frame::NODE);
+      break;
+    }
+
+    case Frame::DOCUMENT_END:
+      // a document that read nothing stopped at a token that no node can
+      // start with, and the next one would only stop there again
+      if (!m_scanner.empty() &&
+          m_scanner.peek_unsafe().type != Token::DOC_END &&
+          m_scanner.peek_unsafe().mark.pos == frame.mark.pos)
+        throw ParserException(frame.mark, ErrorMsg::UNKNOWN_TOKEN);
+
+      eventHandler.OnDocumentEnd();
+
+      // and finally eat any doc ends we see
+      while (!m_scanner.empty() &&
+             m_scanner.peek_unsafe().type == Token::DOC_END)
+        m_scanner.pop_unsafe();
+      m_frames.pop_back();
+      break;
+
+    case Frame::NODE:
+      m_frames.pop_back();
+      HandleNode(eventHandler);
+      break;
+
+    case Frame::BLOCK_SEQ_ENTRY:
+      HandleBlockSequenceEntry(eventHandler);
+      break;
+
+    case Frame::FLOW_SEQ_ENTRY:
+      HandleFlowSequenceEntry(eventHandler);
+      break;
+
+    case Frame::FLOW_SEQ_SEPARATOR:
+      // now eat the separator (or could be a sequence end, which we ignore -
+      // but if it's neither, then it's a bad node)
+      HandleFlowSeparator(Token::FLOW_SEQ_END, ErrorMsg::END_OF_SEQ_FLOW);
+      frame.state = Frame::FLOW_SEQ_ENTRY;
+      break;
+
+    case Frame::BLOCK_MAP_KEY:
+      HandleBlockMapKey(eventHandler);
+      break;
+
+    case Frame::FLOW_MAP_KEY:
+      HandleFlowMapKey(eventHandler);
+      break;
+
+    case Frame::BLOCK_MAP_VALUE:
+    case Frame::FLOW_MAP_VALUE:
+    case Frame::COMPACT_MAP_VALUE:
+      HandleMapValue(eventHandler);
+      break;
+
+    case Frame::FLOW_MAP_SEPARATOR:
+      // now eat the separator (or could be a map end, which we ignore - but
+      // if it's neither, then it's a bad node)
+      HandleFlowSeparator(Token::FLOW_MAP_END, ErrorMsg::END_OF_MAP_FLOW);
+      frame.state = Frame::FLOW_MAP_KEY;
+      break;
+
+    case Frame::COMPACT_MAP_END:
+      m_pCollectionStack->PopCollectionType(CollectionType::CompactMap);
+      eventHandler.OnMapEnd();
+      m_frames.pop_back();
+      break;
+  }
+
+  return !m_frames.empty();
 }
 
-Token::TYPE SingleDocParser::HandleNodeOpen(EventHandler& eventHandler) {
+template <typename Handler>
+Token::TYPE SingleDocParser::HandleNodeOpen(Handler& eventHandler) {
+  typedef HandlerStrings<Handler> Strings;
 
   // an empty node *is* a possibility
   if (m_scanner.empty()) {
@@ -58,13 +146,14 @@ Token::TYPE SingleDocParser::HandleNodeOpen(EventHandler& eventHandler) {
 
   // special case: a value node by itself must be a map, with no header
   if (head.type == Token::VALUE) {
-    eventHandler.OnMapStart(head.mark, "?", NullAnchor, EmitterStyle::Default);
+    eventHandler.OnMapStart(head.mark, Strings::MakeTag(NonSpecificTag(false)),
+                            NullAnchor, EmitterStyle::Default);
     return head.type;
   }
 
   // special case: an alias node
   if (head.type == Token::ALIAS) {
-    eventHandler.OnAlias(head.mark, LookupAnchor(head.mark, head.value));
+    eventHandler.OnAlias(head.mark, LookupAnchor(head.mark, head.scalar()));
     m_scanner.pop_unsafe();
     return Token::NONE;
   }
@@ -72,7 +161,7 @@ Token::TYPE SingleDocParser::HandleNodeOpen(EventHandler& eventHandler) {
   // save location
   Mark mark = head.mark;
 
-  std::string tag;
+  const std::string* tag = nullptr;
   anchor_t anchor = NullAnchor;
 
   bool hasProps = false;
@@ -101,13 +190,15 @@ Token::TYPE SingleDocParser::HandleNodeOpen(EventHandler& eventHandler) {
   Token& token = hasProps ? m_scanner.peek() : head;
 
   // add non-specific tags
-  if (tag.empty())
-    tag = (token.type == Token::NON_PLAIN_SCALAR ? '!' : '?');
+  if (!tag || tag->empty())
+    tag = &NonSpecificTag(token.type == Token::NON_PLAIN_SCALAR);
+  const typename Strings::Tag nodeTag = Strings::MakeTag(*tag);
 
   // now split based on what kind of node we should be
   if (token.type == Token::PLAIN_SCALAR) {
-    if (!IsNullString(token.value)) {
-      eventHandler.OnScalar(mark, tag, anchor, std::move(token.value));
+    const detail::string_view scalar = token.scalar();
+    if (!IsNullString(scalar.str, scalar.length)) {
+      eventHandler.OnScalar(mark, nodeTag, anchor, Strings::MakeValue(token));
     } else {
       eventHandler.OnNull(mark, anchor);
     }
@@ -115,276 +206,255 @@ Token::TYPE SingleDocParser::HandleNodeOpen(EventHandler& eventHandler) {
     return Token::NONE;
 
   } else if (token.type == Token::NON_PLAIN_SCALAR) {
-    eventHandler.OnScalar(mark, tag, anchor, std::move(token.value));
+    eventHandler.OnScalar(mark, nodeTag, anchor, Strings::MakeValue(token));
     m_scanner.pop_unsafe();
     return Token::NONE;
 
   } else if (token.type == Token::FLOW_MAP_START) {
-    eventHandler.OnMapStart(mark, tag, anchor, EmitterStyle::Flow);
+    eventHandler.OnMapStart(mark, nodeTag, anchor, EmitterStyle::Flow);
     return token.type;
 
   } else if (token.type == Token::BLOCK_MAP_START) {
-    eventHandler.OnMapStart(mark, tag, anchor, EmitterStyle::Block);
+    eventHandler.OnMapStart(mark, nodeTag, anchor, EmitterStyle::Block);
     return token.type;
 
   } else if (token.type == Token::FLOW_SEQ_START) {
-    eventHandler.OnSequenceStart(mark, tag, anchor, EmitterStyle::Flow);
+    eventHandler.OnSequenceStart(mark, nodeTag, anchor, EmitterStyle::Flow);
     return token.type;
 
   } else if (token.type == Token::BLOCK_SEQ_START) {
-    eventHandler.OnSequenceStart(mark, tag, anchor, EmitterStyle::Block);
+    eventHandler.OnSequenceStart(mark, nodeTag, anchor, EmitterStyle::Block);
     return token.type;
 
   } else {
     if (token.type == Token::KEY) {
       if (m_pCollectionStack->GetCurCollectionType() == CollectionType::FlowSeq) {
         // compact maps can only go in a flow sequence
-        eventHandler.OnMapStart(mark, tag, anchor, EmitterStyle::Flow);
+        eventHandler.OnMapStart(mark, nodeTag, anchor, EmitterStyle::Flow);
         return token.type;
       }
     }
-    if (tag[0] == '?') {
+    if ((*tag)[0] == '?') {
       eventHandler.OnNull(mark, anchor);
     } else {
-      eventHandler.OnScalar(mark, tag, anchor, "");
+      eventHandler.OnScalar(mark, nodeTag, anchor, Strings::MakeValue("", 0));
     }
   }
   return Token::NONE;
 }
 
-void SingleDocParser::HandleNode(EventHandler& eventHandler) {
-
+template <typename Handler>
+void SingleDocParser::HandleNode(Handler& eventHandler) {
   Token::TYPE type = HandleNodeOpen(eventHandler);
-  if (type == Token::NONE) {
-    return;
-  } else {
-    switch (type) {
-      case Token::FLOW_SEQ_START:
-        HandleFlowSequence(eventHandler);
-        break;
-      case Token::BLOCK_SEQ_START:
-        HandleBlockSequence(eventHandler);
-        break;
-      case Token::FLOW_MAP_START:
-        HandleFlowMap(eventHandler);
-        break;
-      case Token::BLOCK_MAP_START:
-        HandleBlockMap(eventHandler);
-        break;
-      case Token::KEY:
-        HandleCompactMap(eventHandler);
-        break;
-      case Token::VALUE:
-        HandleCompactMapWithNoKey(eventHandler);
-        break;
-      default:
-        break;
-    }
-  }
-}
-
-void SingleDocParser::HandleBlockSequence(EventHandler& eventHandler) {
-  // eat start token
-  m_scanner.pop();
-  m_pCollectionStack->PushCollectionType(CollectionType::BlockSeq);
-
-  while (1) {
-    if (m_scanner.empty())
-      throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_SEQ);
-
-    const Token& token = m_scanner.peek();
-    Token::TYPE type = token.type;
-    if (type != Token::BLOCK_ENTRY && type != Token::BLOCK_SEQ_END)
-      throw ParserException(token.mark, ErrorMsg::END_OF_SEQ);
-
-    m_scanner.pop_unsafe();
-    if (type == Token::BLOCK_SEQ_END)
+  switch (type) {
+    case Token::FLOW_SEQ_START:
+      m_scanner.pop();
+      m_pCollectionStack->PushCollectionType(CollectionType::FlowSeq);
+      PushFrame(Frame::FLOW_SEQ_ENTRY);
       break;
+    case Token::BLOCK_SEQ_START:
+      m_scanner.pop();
+      m_pCollectionStack->PushCollectionType(CollectionType::BlockSeq);
+      PushFrame(Frame::BLOCK_SEQ_ENTRY);
+      break;
+    case Token::FLOW_MAP_START:
+      m_scanner.pop();
+      m_pCollectionStack->PushCollectionType(CollectionType::FlowMap);
+      PushFrame(Frame::FLOW_MAP_KEY);
+      break;
+    case Token::BLOCK_MAP_START:
+      m_scanner.pop();
+      m_pCollectionStack->PushCollectionType(CollectionType::BlockMap);
+      PushFrame(Frame::BLOCK_MAP_KEY);
+      break;
+    case Token::KEY: {
+      // . Single "key: value" pair in a flow sequence
+      m_pCollectionStack->PushCollectionType(CollectionType::CompactMap);
 
-    // check for null
-    if (!m_scanner.empty()) {
-      const Token& token = m_scanner.peek_unsafe();
-      if (token.type == Token::BLOCK_ENTRY ||
-          token.type == Token::BLOCK_SEQ_END) {
-        eventHandler.OnNull(token.mark, NullAnchor);
-        continue;
-      }
-    }
-
-    HandleNode(eventHandler);
-  }
-
-  m_pCollectionStack->PopCollectionType(CollectionType::BlockSeq);
-
-  eventHandler.OnSequenceEnd();
-}
-
-void SingleDocParser::HandleFlowSequence(EventHandler& eventHandler) {
-  // eat start token
-  m_scanner.pop();
-  m_pCollectionStack->PushCollectionType(CollectionType::FlowSeq);
-
-  while (1) {
-    if (m_scanner.empty())
-      throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_SEQ_FLOW);
-
-    // first check for end
-    if (m_scanner.peek_unsafe().type == Token::FLOW_SEQ_END) {
+      // grab key
+      Mark mark = m_scanner.peek().mark;
       m_scanner.pop_unsafe();
+      PushFrame(Frame::COMPACT_MAP_VALUE, mark);
+      PushFrame(Frame::NODE);
       break;
     }
+    case Token::VALUE:
+      // . Single ": value" pair in a flow sequence
+      m_pCollectionStack->PushCollectionType(CollectionType::CompactMap);
 
-    // then read the node
-    HandleNode(eventHandler);
-
-    if (m_scanner.empty())
-      throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_SEQ_FLOW);
+      // null key
+      eventHandler.OnNull(m_scanner.peek().mark, NullAnchor);
 
-    // now eat the separator (or could be a sequence end, which we ignore - but
-    // if it's neither, then it's a bad node)
-    const Token& token = m_scanner.peek_unsafe();
-    if (token.type == Token::FLOW_ENTRY)
+      // grab value
       m_scanner.pop_unsafe();
-    else if (token.type != Token::FLOW_SEQ_END)
-      throw ParserException(token.mark, ErrorMsg::END_OF_SEQ_FLOW);
+      PushFrame(Frame::COMPACT_MAP_END);
+      PushFrame(Frame::NODE);
+      break;
+    default:
+      break;
   }
-
-  m_pCollectionStack->PopCollectionType(CollectionType::FlowSeq);
-
-  eventHandler.OnSequenceEnd();
 }
 
-void SingleDocParser::HandleBlockMap(EventHandler& eventHandler) {
-  // eat start token
-  m_scanner.pop();
-  m_pCollectionStack->PushCollectionType(CollectionType::BlockMap);
+template <typename Handler>
+void SingleDocParser::HandleBlockSequenceEntry(Handler& eventHandler) {
+  if (m_scanner.empty())
+    throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_SEQ);
 
-  while (1) {
-    if (m_scanner.empty())
-      throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_MAP);
+  const Token& token = m_scanner.peek();
+  Token::TYPE type = token.type;
+  if (type != Token::BLOCK_ENTRY && type != Token::BLOCK_SEQ_END)
+    throw ParserException(token.mark, ErrorMsg::END_OF_SEQ);
 
-    const Token& token = m_scanner.peek_unsafe();
-    if (token.type != Token::KEY && token.type != Token::VALUE &&
-        token.type != Token::BLOCK_MAP_END)
-      throw ParserException(token.mark, ErrorMsg::END_OF_MAP);
+  m_scanner.pop_unsafe();
+  if (type == Token::BLOCK_SEQ_END) {
+    m_pCollectionStack->PopCollectionType(CollectionType::BlockSeq);
+    eventHandler.OnSequenceEnd();
+    m_frames.pop_back();
+    return;
+  }
 
-    if (token.type == Token::BLOCK_MAP_END) {
-      m_scanner.pop_unsafe();
-      break;
+  // check for null
+  if (!m_scanner.empty()) {
+    const Token& token = m_scanner.peek_unsafe();
+    if (token.type == Token::BLOCK_ENTRY ||
+        token.type == Token::BLOCK_SEQ_END) {
+      eventHandler.OnNull(token.mark, NullAnchor);
+      return;
     }
+  }
 
-    const Mark mark = token.mark;
+  HandleNode(eventHandler);
+}
 
-    // grab key (if non-null)
-    if (token.type == Token::KEY) {
-      m_scanner.pop_unsafe();
-      HandleNode(eventHandler);
-    } else {
-      eventHandler.OnNull(token.mark, NullAnchor);
-    }
+template <typename Handler>
+void SingleDocParser::HandleFlowSequenceEntry(Handler& eventHandler) {
+  if (m_scanner.empty())
+    throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_SEQ_FLOW);
 
-    // now grab value (optional)
-    if (!m_scanner.empty() && m_scanner.peek_unsafe().type == Token::VALUE) {
-      m_scanner.pop_unsafe();
-      HandleNode(eventHandler);
-    } else {
-      eventHandler.OnNull(mark, NullAnchor);
-    }
+  // first check for end
+  if (m_scanner.peek_unsafe().type == Token::FLOW_SEQ_END) {
+    m_scanner.pop_unsafe();
+    m_pCollectionStack->PopCollectionType(CollectionType::FlowSeq);
+    eventHandler.OnSequenceEnd();
+    m_frames.pop_back();
+    return;
   }
 
-  m_pCollectionStack->PopCollectionType(CollectionType::BlockMap);
-  eventHandler.OnMapEnd();
+  // then read the node
+  m_frames.back().state = Frame::FLOW_SEQ_SEPARATOR;
+  HandleNode(eventHandler);
 }
 
-void SingleDocParser::HandleFlowMap(EventHandler& eventHandler) {
-  // eat start token
-  m_scanner.pop();
-  m_pCollectionStack->PushCollectionType(CollectionType::FlowMap);
+template <typename Handler>
+void SingleDocParser::HandleBlockMapKey(Handler& eventHandler) {
+  if (m_scanner.empty())
+    throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_MAP);
 
-  while (1) {
-    if (m_scanner.empty())
-      throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_MAP_FLOW);
+  const Token& token = m_scanner.peek_unsafe();
+  if (token.type != Token::KEY && token.type != Token::VALUE &&
+      token.type != Token::BLOCK_MAP_END)
+    throw ParserException(token.mark, ErrorMsg::END_OF_MAP);
 
-    const Token& token = m_scanner.peek_unsafe();
-    Mark mark = token.mark;
-    // first check for end
-    if (token.type == Token::FLOW_MAP_END) {
-      m_scanner.pop_unsafe();
-      break;
-    }
+  if (token.type == Token::BLOCK_MAP_END) {
+    m_scanner.pop_unsafe();
+    m_pCollectionStack->PopCollectionType(CollectionType::BlockMap);
+    eventHandler.OnMapEnd();
+    m_frames.pop_back();
+    return;
+  }
 
-    // grab key (if non-null)
-    if (token.type == Token::KEY) {
-      m_scanner.pop_unsafe();
-      HandleNode(eventHandler);
-    } else {
-      eventHandler.OnNull(mark, NullAnchor);
-    }
+  Frame& frame = m_frames.back();
+  frame.state = Frame::BLOCK_MAP_VALUE;
+  frame.mark = token.mark;
 
-    // now grab value (optional)
-    if (!m_scanner.empty() && m_scanner.peek_unsafe().type == Token::VALUE) {
-      m_scanner.pop_unsafe();
-      HandleNode(eventHandler);
-    } else {
-      eventHandler.OnNull(mark, NullAnchor);
-    }
+  // grab key (if non-null)
+  if (token.type == Token::KEY) {
+    m_scanner.pop_unsafe();
+    HandleNode(eventHandler);
+  } else {
+    eventHandler.OnNull(token.mark, NullAnchor);
+  }
+}
 
-    if (m_scanner.empty())
-      throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_MAP_FLOW);
+template <typename Handler>
+void SingleDocParser::HandleFlowMapKey(Handler& eventHandler) {
+  if (m_scanner.empty())
+    throw ParserException(m_scanner.mark(), ErrorMsg::END_OF_MAP_FLOW);
 
-    // now eat the separator (or could be a map end, which we ignore - but if
-    // it's neither, then it's a bad node)
-    const Token& nextToken = m_scanner.peek_unsafe();
-    if (nextToken.type == Token::FLOW_ENTRY)
-      m_scanner.pop_unsafe();
-    else if (nextToken.type != Token::FLOW_MAP_END)
-      throw ParserException(nextToken.mark, ErrorMsg::END_OF_MAP_FLOW);
+  const Token& token = m_scanner.peek_unsafe();
+  // first check for end
+  if (token.type == Token::FLOW_MAP_END) {
+    m_scanner.pop_unsafe();
+    m_pCollectionStack->PopCollectionType(CollectionType::FlowMap);
+    eventHandler.OnMapEnd();
+    m_frames.pop_back();
+    return;
   }
 
-  m_pCollectionStack->PopCollectionType(CollectionType::FlowMap);
-  eventHandler.OnMapEnd();
-}
+  Frame& frame = m_frames.back();
+  frame.state = Frame::FLOW_MAP_VALUE;
+  frame.mark = token.mark;
 
-// . Single "key: value" pair in a flow sequence
-void SingleDocParser::HandleCompactMap(EventHandler& eventHandler) {
-  m_pCollectionStack->PushCollectionType(CollectionType::CompactMap);
+  // grab key (if non-null)
+  if (token.type == Token::KEY) {
+    m_scanner.pop_unsafe();
+    HandleNode(eventHandler);
+  } else {
+    eventHandler.OnNull(frame.mark, NullAnchor);
+  }
+}
 
-  // grab key
-  Mark mark = m_scanner.peek().mark;
-  m_scanner.pop_unsafe();
-  HandleNode(eventHandler);
+// HandleMapValue
+// . Grabs the (optional) value of any kind of map; the frame holds the mark
+//   of its key
+template <typename Handler>
+void SingleDocParser::HandleMapValue(Handler& eventHandler) {
+  Frame& frame = m_frames.back();
+  const Mark mark = frame.mark;
+  switch (frame.state) {
+    case Frame::BLOCK_MAP_VALUE:
+      frame.state = Frame::BLOCK_MAP_KEY;
+      break;
+    case Frame::FLOW_MAP_VALUE:
+      frame.state = Frame::FLOW_MAP_SEPARATOR;
+      break;
+    default:
+      frame.state = Frame::COMPACT_MAP_END;
+      break;
+  }
 
-  // now grab value (optional)
   if (!m_scanner.empty() && m_scanner.peek_unsafe().type == Token::VALUE) {
     m_scanner.pop_unsafe();
     HandleNode(eventHandler);
   } else {
     eventHandler.OnNull(mark, NullAnchor);
   }
-
-  m_pCollectionStack->PopCollectionType(CollectionType::CompactMap);
-  eventHandler.OnMapEnd();
 }
 
-// . Single ": value" pair in a flow sequence
-void SingleDocParser::HandleCompactMapWithNoKey(EventHandler& eventHandler) {
-  m_pCollectionStack->PushCollectionType(CollectionType::CompactMap);
+void SingleDocParser::HandleFlowSeparator(Token::TYPE end,
+                                          const char* const error) {
+  if (m_scanner.empty())
+    throw ParserException(m_scanner.mark(), error);
 
-  // null key
-  eventHandler.OnNull(m_scanner.peek().mark, NullAnchor);
-
-  // grab value
-  m_scanner.pop_unsafe();
-  HandleNode(eventHandler);
+  const Token& token = m_scanner.peek_unsafe();
+  if (token.type == Token::FLOW_ENTRY)
+    m_scanner.pop_unsafe();
+  else if (token.type != end)
+    throw ParserException(token.mark, error);
+}
 
-  m_pCollectionStack->PopCollectionType(CollectionType::CompactMap);
-  eventHandler.OnMapEnd();
+void SingleDocParser::PushFrame(Frame::STATE state, const Mark& mark) {
+  Frame frame;
+  frame.state = state;
+  frame.mark = mark;
+  m_frames.push_back(frame);
 }
 
 // ParseProperties
 // . Grabs any tag or anchor tokens and deals with them.
-bool SingleDocParser::ParseProperties(std::string& tag, anchor_t& anchor) {
-  tag.clear();
+bool SingleDocParser::ParseProperties(const std::string*& tag,
+                                      anchor_t& anchor) {
+  tag = nullptr;
   anchor = NullAnchor;
   bool hasProps = false;
 
@@ -395,10 +465,10 @@ bool SingleDocParser::ParseProperties(std::string& tag, anchor_t& anchor) {
     switch (token.type) {
       case Token::TAG:
         //ParseTag(tag);
-        if (!tag.empty())
+        if (tag && !tag->empty())
           throw ParserException(token.mark, ErrorMsg::MULTIPLE_TAGS);
 
-        tag = Tag(token).Translate(m_directives);
+        tag = &Tag(token).Translate(m_directives);
         m_scanner.pop_unsafe();
         hasProps = true;
         break;
@@ -408,7 +478,7 @@ bool SingleDocParser::ParseProperties(std::string& tag, anchor_t& anchor) {
         if (anchor)
           throw ParserException(token.mark, ErrorMsg::MULTIPLE_ANCHORS);
 
-        anchor = RegisterAnchor(token.value);
+        anchor = RegisterAnchor(token.scalar());
         m_scanner.pop_unsafe();
         hasProps = true;
         break;
@@ -420,13 +490,13 @@ bool SingleDocParser::ParseProperties(std::string& tag, anchor_t& anchor) {
   return hasProps;
 }
 
-void SingleDocParser::ParseTag(std::string& tag) {
+void SingleDocParser::ParseTag(const std::string*& tag) {
   const Token& token = m_scanner.peek();
-  if (!tag.empty())
+  if (tag && !tag->empty())
     throw ParserException(token.mark, ErrorMsg::MULTIPLE_TAGS);
 
   Tag tagInfo(token);
-  tag = tagInfo.Translate(m_directives);
+  tag = &tagInfo.Translate(m_directives);
   m_scanner.pop_unsafe();
 }
 
@@ -435,23 +505,34 @@ void SingleDocParser::ParseAnchor(anchor_t& anchor) {
   if (anchor)
     throw ParserException(token.mark, ErrorMsg::MULTIPLE_ANCHORS);
 
-  anchor = RegisterAnchor(token.value);
+  anchor = RegisterAnchor(token.scalar());
   m_scanner.pop_unsafe();
 }
 
-anchor_t SingleDocParser::RegisterAnchor(const std::string& name) {
-  if (name.empty())
+anchor_t SingleDocParser::RegisterAnchor(detail::string_view name) {
+  if (name.length == 0)
     return NullAnchor;
 
-  return m_anchors[name] = ++m_curAnchor;
+  m_anchors.Set(name.str, name.length, ++m_curAnchor);
+  return m_curAnchor;
 }
 
 anchor_t SingleDocParser::LookupAnchor(const Mark& mark,
-                                       const std::string& name) const {
-  Anchors::const_iterator it = m_anchors.find(name);
-  if (it == m_anchors.end())
+                                       detail::string_view name) const {
+  anchor_t anchor = m_anchors.Find(name.str, name.length);
+  if (anchor == NullAnchor)
     throw ParserException(mark, ErrorMsg::UNKNOWN_ANCHOR);
 
-  return it->second;
+  return anchor;
+}
+
+const std::string& SingleDocParser::NonSpecificTag(bool nonPlainScalar) {
+  static const std::string plainTag("?");
+  static const std::string nonPlainTag("!");
+  return nonPlainScalar ? nonPlainTag : plainTag;
 }
+
+template void SingleDocParser::HandleDocument(EventHandler& eventHandler);
+template void SingleDocParser::HandleDocument(ViewEventHandler& eventHandler);
+template bool SingleDocParser::HandleStep(ViewEventHandler& eventHandler);
 }
@@ -1,10 +1,14 @@
 #pragma once
 
-#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "anchortable.h"
+#include "token.h"
 #include "yaml-cpp/anchor.h"
+#include "yaml-cpp/mark.h"
+#include "yaml-cpp/node/detail/string_view.h"
 #include "yaml-cpp/noncopyable.h"
 
 namespace YAML {
@@ -12,43 +16,93 @@ class CollectionStack;
 class EventHandler;
 class Node;
 class Scanner;
+class ViewEventHandler;
 struct Directives;
-struct Mark;
-struct Token;
 
 class SingleDocParser : private noncopyable {
  public:
   SingleDocParser(Scanner& scanner, const Directives& directives);
   ~SingleDocParser();
 
-  void HandleDocument(EventHandler& eventHandler);
+  /**
+   * Handles the next document. Instantiated for EventHandler and
+   * ViewEventHandler, which differ only in how they're given strings.
+   */
+  template <typename Handler>
+  void HandleDocument(Handler& eventHandler);
+
+  /**
+   * Handles the next document a step at a time, for readers that pull
+   * events: a step sends at most two events (sometimes none), and a scalar
+   * is always the last of them. Returns false once OnDocumentEnd has been
+   * sent. Instantiated for ViewEventHandler.
+   */
+  template <typename Handler>
+  bool HandleStep(Handler& eventHandler);
 
  private:
-  void HandleNode(EventHandler& eventHandler);
-  Token::TYPE HandleNodeOpen(EventHandler& eventHandler);
+  // Where the parser is in the document: one frame per open collection, in
+  // the state of the loop that would read it. A NODE frame is a node still
+  // to be read (the document's, or a compact map's key or value).
+  struct Frame {
+    enum STATE : char {
+      DOCUMENT_START,
+      DOCUMENT_END,
+      NODE,
+      BLOCK_SEQ_ENTRY,
+      FLOW_SEQ_ENTRY,
+      FLOW_SEQ_SEPARATOR,
+      BLOCK_MAP_KEY,
+      BLOCK_MAP_VALUE,
+      FLOW_MAP_KEY,
+      FLOW_MAP_VALUE,
+      FLOW_MAP_SEPARATOR,
+      COMPACT_MAP_VALUE,
+      COMPACT_MAP_END
+    };
+
+    STATE state;
+    Mark mark;  // of the current key, in a map, or of the document's start
+  };
+
+  template <typename Handler>
+  void HandleNode(Handler& eventHandler);
+  template <typename Handler>
+  Token::TYPE HandleNodeOpen(Handler& eventHandler);
 
-  void HandleBlockSequence(EventHandler& eventHandler);
-  void HandleFlowSequence(EventHandler& eventHandler);
+  template <typename Handler>
+  void HandleBlockSequenceEntry(Handler& eventHandler);
+  template <typename Handler>
+  void HandleFlowSequenceEntry(Handler& eventHandler);
 
-  void HandleBlockMap(EventHandler& eventHandler);
-  void HandleFlowMap(EventHandler& eventHandler);
-  void HandleCompactMap(EventHandler& eventHandler);
-  void HandleCompactMapWithNoKey(EventHandler& eventHandler);
+  template <typename Handler>
+  void HandleBlockMapKey(Handler& eventHandler);
+  template <typename Handler>
+  void HandleFlowMapKey(Handler& eventHandler);
+  template <typename Handler>
+  void HandleMapValue(Handler& eventHandler);
 
-  bool ParseProperties(std::string& tag, anchor_t& anchor);
-  void ParseTag(std::string& tag);
+  void HandleFlowSeparator(Token::TYPE end, const char* const error);
+  void PushFrame(Frame::STATE state, const Mark& mark = Mark());
+
+  bool ParseProperties(const std::string*& tag, anchor_t& anchor);
+  void ParseTag(const std::string*& tag);
   void ParseAnchor(anchor_t& anchor);
 
-  anchor_t RegisterAnchor(const std::string& name);
-  anchor_t LookupAnchor(const Mark& mark, const std::string& name) const;
+  // the tag of a node without one: "!" for a quoted or block scalar, "?"
+  // otherwise
+  static const std::string& NonSpecificTag(bool nonPlainScalar);
+
+  anchor_t RegisterAnchor(detail::string_view name);
+  anchor_t LookupAnchor(const Mark& mark, detail::string_view name) const;
 
  private:
   Scanner& m_scanner;
   const Directives& m_directives;
   std::unique_ptr<CollectionStack> m_pCollectionStack;
+  std::vector<Frame> m_frames;
 
-  typedef std::map<std::string, anchor_t> Anchors;
-  Anchors m_anchors;
+  AnchorTable m_anchors;
 
   anchor_t m_curAnchor;
 };
@@ -1,9 +1,14 @@
 #include <iostream>
 
 #include "stream.h"
+#include "charsearch.h"
 #include "streamcharsource.h"
 #include "exp.h"
+#include "transcoder.h"
+#include "utf8.h"
 
+#include <algorithm>
+#include <chrono>
 #include <sstream>
 
 #ifndef YAML_PREFETCH_SIZE
@@ -11,13 +16,20 @@
 //#define YAML_PREFETCH_SIZE 1024
 #endif
 
+// Blocks handed over by the background reader are larger, so that the
+// hand-over cost is small next to the time it takes to scan them
+#ifndef YAML_READAHEAD_BLOCK_SIZE
+#define YAML_READAHEAD_BLOCK_SIZE 65536
+#endif
+#ifndef YAML_READAHEAD_BLOCK_COUNT
+#define YAML_READAHEAD_BLOCK_COUNT 3
+#endif
+
 #define S_ARRAY_SIZE(A) (sizeof(A) / sizeof(*(A)))
 #define S_ARRAY_END(A) ((A) + S_ARRAY_SIZE(A))
 
 #define likely(x)       __builtin_expect(!!(x), 1)
 
-#define CP_REPLACEMENT_CHARACTER (0xFFFD)
-
 namespace YAML {
 enum UtfIntroState {
   uis_start,
@@ -165,42 +177,24 @@ inline UtfIntroCharType IntroCharTypeOf(std::istream::int_type ch) {
   return uictOther;
 }
 
-inline char Utf8Adjust(unsigned long ch, unsigned char lead_bits,
-                       unsigned char rshift) {
-  const unsigned char header = ((1 << lead_bits) - 1) << (8 - lead_bits);
-  const unsigned char mask = (0xFF >> (lead_bits + 1));
-  return static_cast<char>(
-      static_cast<unsigned char>(header | ((ch >> rshift) & mask)));
-}
-
-inline void Stream::QueueUnicodeCodepoint(unsigned long ch) const {
-  // We are not allowed to queue the Stream::eof() codepoint, so
-  // replace it with CP_REPLACEMENT_CHARACTER
-
-  auto& q = m_readahead;
-
-  if (static_cast<unsigned long>(Stream::eof()) == ch) {
-    ch = CP_REPLACEMENT_CHARACTER;
-  }
-
-  if (ch < 0x80) {
-    q.push_back(Utf8Adjust(ch, 0, 0));
-  } else if (ch < 0x800) {
-    q.push_back(Utf8Adjust(ch, 2, 6));
-    q.push_back(Utf8Adjust(ch, 1, 0));
-  } else if (ch < 0x10000) {
-    q.push_back(Utf8Adjust(ch, 3, 12));
-    q.push_back(Utf8Adjust(ch, 1, 6));
-    q.push_back(Utf8Adjust(ch, 1, 0));
-  } else {
-    q.push_back(Utf8Adjust(ch, 4, 18));
-    q.push_back(Utf8Adjust(ch, 1, 12));
-    q.push_back(Utf8Adjust(ch, 1, 6));
-    q.push_back(Utf8Adjust(ch, 1, 0));
+Transcoder::Encoding Stream::TranscoderEncoding(CharacterSet charSet) {
+  switch (charSet) {
+    case utf8:
+      return Transcoder::utf8;
+    case utf16le:
+      return Transcoder::utf16le;
+    case utf16be:
+      return Transcoder::utf16be;
+    case utf32le:
+      return Transcoder::utf32le;
+    case utf32be:
+      return Transcoder::utf32be;
+    default:
+      assert(false);
   }
+  return Transcoder::utf16le;
 }
 
-
 Stream::CharacterSet Stream::determineCharachterSet(std::istream& input, int& skip) {
   // Determine (or guess) the character-set by reading the BOM, if any.  See
   // the YAML specification for the determination algorithm.
@@ -245,25 +239,60 @@ Stream::CharacterSet Stream::determineCharachterSet(std::istream& input, int& sk
 }
 
 Stream::Stream(const std::string& input)
-    : m_input(nullptr),
+    : Stream(input.data(), input.size()) {}
+
+Stream::Stream(const char* input, std::size_t size,
+               const ParseOptions& options, const Mark& start)
+    : m_pos(start.pos),
+      m_line(start.line),
+      m_lineStart(start.pos - start.column),
+      m_input(nullptr),
       m_pPrefetched(new unsigned char[YAML_PREFETCH_SIZE]),
+      m_pBlock(m_pPrefetched),
       m_nPrefetchedAvailable(0),
       m_nPrefetchedUsed(0) {
 
-    std::stringstream ss(input.substr(0, 5));
-    int skip = 0;
-    m_charSet = determineCharachterSet(ss, skip);
+    m_lookahead.streamPos = start.pos;
+
+    // a piece that starts past the beginning of its input has no BOM of its
+    // own, and is UTF-8 like the rest
+    if (start.pos > 0) {
+        m_charSet = utf8;
+    } else {
+        std::stringstream ss(
+            std::string(input, std::min<std::size_t>(size, 5)));
+        int skip = 0;
+        m_charSet = determineCharachterSet(ss, skip);
 
-    if (m_charSet == utf8) {
         // Skip UTF-8 BOM
-        m_readaheadSize = input.size() - skip;
-        m_buffer = input.data() + skip;
+        input += skip;
+        size -= skip;
+    }
 
-    } else {
-        m_readaheadSize = 0;
+    // UTF-8 is read in place, ill-formed bytes and all, unless the caller
+    // asked for it to be repaired; checking it then costs one pass at memory
+    // speed, and well-formed input is still read in place
+    std::size_t valid = 0;
+    if (m_charSet == utf8) {
+        valid = options.repairUtf8 ? Utf8::ValidPrefix(input, size) : size;
+    }
+
+    if (valid == size) {
+        m_readaheadSize = size;
+        m_buffer = input;
 
-        m_input = new std::stringstream({input.begin() + skip, input.end()});
-        m_ownInput = true;
+    } else {
+        // Convert (or repair) everything up front, so the scanner still sees
+        // one contiguous UTF-8 buffer
+        Transcoder transcoder(TranscoderEncoding(m_charSet));
+        m_readahead.reserve(size);
+        m_readahead.assign(input, input + valid);
+        transcoder.Append(reinterpret_cast<const unsigned char*>(input) + valid,
+                          size - valid, m_readahead);
+        transcoder.Finish(m_readahead);
+
+        m_readaheadSize = m_readahead.size();
+        m_buffer = m_readahead.data();
     }
 
     ReadAheadTo(0);
@@ -275,9 +304,10 @@ Stream::Stream(const std::string& input)
     }
 }
 
-Stream::Stream(std::istream& input)
+Stream::Stream(std::istream& input, const ParseOptions& options)
     : m_input(&input),
       m_pPrefetched(new unsigned char[YAML_PREFETCH_SIZE]),
+      m_pBlock(m_pPrefetched),
       m_nPrefetchedAvailable(0),
       m_nPrefetchedUsed(0) {
 
@@ -287,6 +317,18 @@ Stream::Stream(std::istream& input)
   int skip;
   m_charSet = determineCharachterSet(input, skip);
 
+  m_readahead.reserve(2 * YAML_PREFETCH_SIZE);
+  if (m_charSet != utf8 || options.repairUtf8) {
+    m_transcoder.reset(new Transcoder(TranscoderEncoding(m_charSet)));
+  }
+
+  // the encoding detection above has read through the istream, so the
+  // helper thread may only take over the buffer now
+  if (options.backgroundReadAhead && input.good()) {
+    m_readAhead.reset(new ReadAhead(*input.rdbuf(), YAML_READAHEAD_BLOCK_SIZE,
+                                    YAML_READAHEAD_BLOCK_COUNT));
+  }
+
   ReadAheadTo(0);
 
   if (m_readaheadSize > 0) {
@@ -297,12 +339,11 @@ Stream::Stream(std::istream& input)
 }
 
 Stream::~Stream() {
+    // stop the helper thread before the stream it reads can go away
+    m_readAhead.reset();
     if (m_pPrefetched) {
         delete[] m_pPrefetched;
     }
-    if (m_ownInput) {
-        delete m_input;
-    }
 }
 
 // get
@@ -336,14 +377,12 @@ void Stream::eat(int n) {
 void Stream::AdvanceCurrent() {
 
     m_readaheadPos++;
-    m_mark.pos++;
+    m_pos++;
 
    // FIXME - what about escaped newlines?
-   if (likely(m_char != '\n')) {
-       m_mark.column++;
-   } else {
-       m_mark.column = 0;
-       m_mark.line++;
+   if (unlikely(m_char == '\n')) {
+       m_line++;
+       m_lineStart = m_pos;
    }
 
    if (likely(ReadAheadTo(0))) {
@@ -353,63 +392,30 @@ void Stream::AdvanceCurrent() {
    }
 }
 
+// EatSpace, EatBlanks, EatToEndOfLine
+// . Skip a whole run of characters per step, over what is buffered; in istream
+//   mode EatInLine refills the window and we look again.
 void Stream::EatSpace() {
-  if (m_char != ' ') { return; }
-
-  int pos = m_readaheadPos;
-  int available = m_readaheadSize;
-
-  char ch;
-  do {
-    if (++pos == available) {
-      int count = pos - m_readaheadPos;
-      m_readaheadPos = pos;
-
-      m_mark.pos += count;
-      m_mark.column += count;
-
-      if (!ReadAheadTo(0)) {
-        m_char = Stream::eof();
-        return;
-      }
-      pos = m_readaheadPos;
-      available = m_readaheadSize;
-    }
-
-    ch = m_buffer[pos];
-
-  } while (ch == ' ');
-
-  int count = pos - m_readaheadPos;
-  m_readaheadPos = pos;
-
-  m_mark.pos += count;
-  m_mark.column += count;
-
-  if (!ReadAheadTo(0)) {
-    m_char = Stream::eof();
-    return;
+  while (m_char == ' ') {
+    const char* begin = data();
+    EatInLine(CharSearch::SkipAny<' '>(begin, begin + available()) - begin);
   }
-
-  m_char = m_buffer[m_readaheadPos];
 }
 
 bool Stream::EatLineBreak() {
 
   if (m_char == '\n') {
     m_readaheadPos++;
-    m_mark.pos++;
-    m_mark.column = 0;
-    m_mark.line++;
+    m_pos++;
   } else if (m_char == '\r' &&
              (ReadAheadTo(1) && m_buffer[m_readaheadPos + 1] == '\n')) {
     m_readaheadPos += 2;
-    m_mark.pos += 2;
-    m_mark.column = 0;
-    m_mark.line++;
+    m_pos += 2;
   } else {
     return false;
   }
+  m_line++;
+  m_lineStart = m_pos;
 
   if (ReadAheadTo(0)) {
     m_char = m_buffer[m_readaheadPos];
@@ -420,34 +426,19 @@ bool Stream::EatLineBreak() {
 }
 
 void Stream::EatToEndOfLine() {
-
   while (m_char != '\n' && m_char != Stream::eof()) {
-
-    m_readaheadPos++;
-    m_mark.pos++;
-    m_mark.column++;
-
-    if (ReadAheadTo(0)) {
-      m_char = m_buffer[m_readaheadPos];
-    } else {
-      m_char = Stream::eof();
-    }
+    const char* begin = data();
+    EatInLine(CharSearch::FindAny<'\n', Stream::eof()>(begin,
+                                                       begin + available()) -
+              begin);
   }
 }
 
 void Stream::EatBlanks() {
-
   while (m_char == ' ' || m_char == '\t') {
-
-    m_readaheadPos++;
-    m_mark.pos++;
-    m_mark.column++;
-
-    if (ReadAheadTo(0)) {
-      m_char = m_buffer[m_readaheadPos];
-    } else {
-      m_char = Stream::eof();
-    }
+    const char* begin = data();
+    EatInLine(CharSearch::SkipAny<' ', '\t'>(begin, begin + available()) -
+              begin);
   }
 }
 
@@ -501,29 +492,21 @@ void Stream::UpdateLookahead() const {
 bool Stream::_ReadAheadTo(size_t i) const {
     if (!m_input) { return false; }
 
-    const size_t readaheadLimit = 32;
-    if (m_readaheadPos > readaheadLimit + i) {
-        m_readahead.erase(m_readahead.begin(), m_readahead.begin() + readaheadLimit);
-        m_readaheadPos -= readaheadLimit;
+    // Slide the window only once a whole prefetch block has been consumed,
+    // so the unread tail is moved at most once per block.
+    if (m_readaheadPos >= YAML_PREFETCH_SIZE) {
+        size_t remaining = m_readahead.size() - m_readaheadPos;
+        std::memmove(m_readahead.data(), m_readahead.data() + m_readaheadPos,
+                     remaining);
+        m_readahead.resize(remaining);
+        m_readaheadPos = 0;
     }
 
     while (m_input->good() && (m_readahead.size()  - m_readaheadPos <= i)) {
-    switch (m_charSet) {
-      case utf8:
-        StreamInUtf8();
-        break;
-      case utf16le:
-        StreamInUtf16();
-        break;
-      case utf16be:
-        StreamInUtf16();
-        break;
-      case utf32le:
-        StreamInUtf32();
-        break;
-      case utf32be:
-        StreamInUtf32();
-        break;
+    if (m_transcoder) {
+      StreamInTranscoded();
+    } else {
+      StreamInUtf8();
     }
   }
 
@@ -537,121 +520,71 @@ bool Stream::_ReadAheadTo(size_t i) const {
   return m_readahead.size() - m_readaheadPos > i;
 }
 
+// StreamInUtf8
+// . Appends everything that is left of the current prefetch block at once,
+//   fetching a new block first if it has been used up.
 void Stream::StreamInUtf8() const {
-  unsigned char b = GetNextByte();
-  if (m_input->good()) {
-    m_readahead.push_back(b);
-  }
-}
-
-void Stream::StreamInUtf16() const {
-  unsigned long ch = 0;
-  unsigned char bytes[2];
-  int nBigEnd = (m_charSet == utf16be) ? 0 : 1;
-
-  bytes[0] = GetNextByte();
-  bytes[1] = GetNextByte();
-  if (!m_input->good()) {
+  if (m_nPrefetchedUsed >= m_nPrefetchedAvailable && !FetchBlock()) {
     return;
   }
-  ch = (static_cast<unsigned long>(bytes[nBigEnd]) << 8) |
-       static_cast<unsigned long>(bytes[1 ^ nBigEnd]);
 
-  if (ch >= 0xDC00 && ch < 0xE000) {
-    // Trailing (low) surrogate...ugh, wrong order
-    QueueUnicodeCodepoint(CP_REPLACEMENT_CHARACTER);
-    return;
-  } else if (ch >= 0xD800 && ch < 0xDC00) {
-    // ch is a leading (high) surrogate
-
-    // Four byte UTF-8 code point
-
-    // Read the trailing (low) surrogate
-    for (;;) {
-      bytes[0] = GetNextByte();
-      bytes[1] = GetNextByte();
-      if (!m_input->good()) {
-        QueueUnicodeCodepoint(CP_REPLACEMENT_CHARACTER);
-        return;
-      }
-      unsigned long chLow = (static_cast<unsigned long>(bytes[nBigEnd]) << 8) |
-                            static_cast<unsigned long>(bytes[1 ^ nBigEnd]);
-      if (chLow < 0xDC00 || chLow >= 0xE000) {
-        // Trouble...not a low surrogate.  Dump a REPLACEMENT CHARACTER into the
-        // stream.
-        QueueUnicodeCodepoint(CP_REPLACEMENT_CHARACTER);
-
-        // Deal with the next UTF-16 unit
-        if (chLow < 0xD800 || chLow >= 0xE000) {
-          // Easiest case: queue the codepoint and return
-          QueueUnicodeCodepoint(ch);
-          return;
-        } else {
-          // Start the loop over with the new high surrogate
-          ch = chLow;
-          continue;
-        }
-      }
-
-      // Select the payload bits from the high surrogate
-      ch &= 0x3FF;
-      ch <<= 10;
-
-      // Include bits from low surrogate
-      ch |= (chLow & 0x3FF);
-
-      // Add the surrogacy offset
-      ch += 0x10000;
-      break;
-    }
-  }
+  size_t count = m_nPrefetchedAvailable - m_nPrefetchedUsed;
+  size_t size = m_readahead.size();
+  m_readahead.resize(size + count);
+  std::memcpy(m_readahead.data() + size, m_pBlock + m_nPrefetchedUsed, count);
 
-  QueueUnicodeCodepoint(ch);
+  m_nPrefetchedUsed = m_nPrefetchedAvailable;
 }
 
 inline char* ReadBuffer(unsigned char* pBuffer) {
   return reinterpret_cast<char*>(pBuffer);
 }
 
-unsigned char Stream::GetNextByte() const {
-  if (m_nPrefetchedUsed >= m_nPrefetchedAvailable) {
+bool Stream::FetchBlock() const {
+  if (m_readAhead) {
+    m_nPrefetchedAvailable = m_readAhead->Next(m_pBlock);
+  } else {
+    auto start = std::chrono::steady_clock::now();
     std::streambuf* pBuf = m_input->rdbuf();
-
-    m_nPrefetchedAvailable = static_cast<std::size_t>(pBuf->sgetn(ReadBuffer(m_pPrefetched), YAML_PREFETCH_SIZE));
-
-    m_nPrefetchedUsed = 0;
-    if (!m_nPrefetchedAvailable) {
-      m_input->setstate(std::ios_base::eofbit);
-    }
-
-    if (0 == m_nPrefetchedAvailable) {
-      return 0;
+    m_nPrefetchedAvailable = static_cast<std::size_t>(
+        pBuf->sgetn(ReadBuffer(m_pPrefetched), YAML_PREFETCH_SIZE));
+    auto stalled = std::chrono::steady_clock::now() - start;
+
+    m_stats.stalls++;
+    m_stats.stallNanoseconds += static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stalled).count());
+    if (m_nPrefetchedAvailable) {
+      m_stats.bytesRead += m_nPrefetchedAvailable;
+      m_stats.blocksRead++;
     }
   }
+  m_nPrefetchedUsed = 0;
 
-  return m_pPrefetched[m_nPrefetchedUsed++];
+  if (!m_nPrefetchedAvailable) {
+    m_input->setstate(std::ios_base::eofbit);
+    return false;
+  }
+  return true;
 }
 
-void Stream::StreamInUtf32() const {
-  static int indexes[2][4] = {{3, 2, 1, 0}, {0, 1, 2, 3}};
+unsigned char Stream::GetNextByte() const {
+  if (m_nPrefetchedUsed >= m_nPrefetchedAvailable && !FetchBlock()) {
+    return 0;
+  }
 
-  unsigned long ch = 0;
-  unsigned char bytes[4];
-  int* pIndexes = (m_charSet == utf32be) ? indexes[1] : indexes[0];
+  return m_pBlock[m_nPrefetchedUsed++];
+}
 
-  bytes[0] = GetNextByte();
-  bytes[1] = GetNextByte();
-  bytes[2] = GetNextByte();
-  bytes[3] = GetNextByte();
-  if (!m_input->good()) {
+void Stream::StreamInTranscoded() const {
+  if (m_nPrefetchedUsed >= m_nPrefetchedAvailable && !FetchBlock()) {
+    m_transcoder->Finish(m_readahead);
     return;
   }
 
-  for (int i = 0; i < 4; ++i) {
-    ch <<= 8;
-    ch |= bytes[pIndexes[i]];
-  }
+  m_transcoder->Append(m_pBlock + m_nPrefetchedUsed,
+                       m_nPrefetchedAvailable - m_nPrefetchedUsed,
+                       m_readahead);
 
-  QueueUnicodeCodepoint(ch);
+  m_nPrefetchedUsed = m_nPrefetchedAvailable;
 }
 }
@@ -2,10 +2,14 @@
 
 #include "yaml-cpp/noncopyable.h"
 #include "yaml-cpp/mark.h"
+#include "yaml-cpp/parseoptions.h"
+#include "readahead.h"
 #include "streamcharsource.h"
+#include "transcoder.h"
 
 #include <cstddef>
 #include <deque>
+#include <memory>
 #include <vector>
 #include <ios>
 #include <iostream>
@@ -20,8 +24,15 @@ class Stream : private noncopyable {
  public:
   friend class StreamCharSource;
 
-  Stream(std::istream& input);
+  Stream(std::istream& input, const ParseOptions& options = ParseOptions());
   Stream(const std::string& input);
+  // Reads directly from a contiguous buffer; it must outlive the Stream.
+  // Marks are reported relative to 'start', so a buffer holding a later
+  // slice of a larger input keeps that input's positions; such a slice is
+  // read as UTF-8, without looking for a BOM.
+  Stream(const char* input, std::size_t size,
+         const ParseOptions& options = ParseOptions(),
+         const Mark& start = Mark());
   ~Stream();
 
   operator bool() const {
@@ -40,10 +51,9 @@ class Stream : private noncopyable {
   // NB: Do not use to eat line breaks! Use eat(n) instead.
   void eat() {
     m_readaheadPos++;
-    m_mark.pos++;
+    m_pos++;
 
     assert(m_char != '\n');
-    m_mark.column++;
 
     if (ReadAheadTo(0)) {
       m_char = m_buffer[m_readaheadPos];
@@ -54,11 +64,50 @@ class Stream : private noncopyable {
 
   static constexpr char eof() { return 0x04; }
 
-  const Mark mark() const { return m_mark; }
-  int pos() const { return m_mark.pos; }
-  int line() const { return m_mark.line; }
-  int column() const { return m_mark.column; }
-  void ResetColumn() { m_mark.column = 0; }
+  // The input buffered from the current position on, for scanning runs of
+  // characters in place. It may end before the input does (when reading an
+  // istream); eat what was scanned and look again.
+  const char* data() const { return m_buffer + m_readaheadPos; }
+  std::size_t available() const { return m_readaheadSize - m_readaheadPos; }
+
+  // Whether data() holds all of the remaining input, in place for as long as
+  // the stream lives (rather than a window that moves as it is read).
+  bool contiguous() const { return m_input == nullptr; }
+
+  // Buffers at least 'n' characters if the input has that many left, and
+  // returns available(). This may move the buffer, so call data() again.
+  std::size_t Prefetch(std::size_t n) const {
+    ReadAheadTo(n - 1);
+    return available();
+  }
+
+  // Eats 'n' characters, none of which may be a line break.
+  void EatInLine(std::size_t n) {
+    m_readaheadPos += n;
+    m_pos += static_cast<int>(n);
+
+    if (ReadAheadTo(0)) {
+      m_char = m_buffer[m_readaheadPos];
+    } else {
+      m_char = Stream::eof();
+    }
+  }
+
+  const InputStats& stats() const {
+    return m_readAhead ? m_readAhead->stats() : m_stats;
+  }
+
+  const Mark mark() const {
+    Mark mark;
+    mark.pos = m_pos;
+    mark.line = m_line;
+    mark.column = m_pos - m_lineStart;
+    return mark;
+  }
+  int pos() const { return m_pos; }
+  int line() const { return m_line; }
+  int column() const { return m_pos - m_lineStart; }
+  void ResetColumn() { m_lineStart = m_pos; }
   void EatSpace();
   void EatToEndOfLine();
   void EatBlanks();
@@ -72,7 +121,7 @@ class Stream : private noncopyable {
   }
 
   void LookaheadBuffer(Exp::Source<2>& out) const {
-    int offset = m_mark.pos - m_lookahead.streamPos;
+    int offset = m_pos - m_lookahead.streamPos;
     if (m_lookahead.available > 2 + offset) {
       out[0] = m_lookahead.buffer[offset];
       out[1] = m_lookahead.buffer[offset+1];
@@ -86,7 +135,7 @@ class Stream : private noncopyable {
   }
 
   void LookaheadBuffer(Exp::Source<4>& out) const {
-    int offset = m_mark.pos - m_lookahead.streamPos;
+    int offset = m_pos - m_lookahead.streamPos;
     auto dst = reinterpret_cast<uint32_t*>(out.data());
 
     if (__builtin_expect(m_lookahead.available > 4 + offset, 1)) {
@@ -101,7 +150,7 @@ class Stream : private noncopyable {
   }
 
   const Exp::StreamSource& GetLookaheadBuffer(int lookahead) const {
-    int offset = m_mark.pos - m_lookahead.streamPos;
+    int offset = m_pos - m_lookahead.streamPos;
     if (offset == 0 && m_lookahead.available >= lookahead) {
       return m_lookahead.buffer;
     }
@@ -128,7 +177,11 @@ class Stream : private noncopyable {
     Exp::StreamSource buffer;
   } m_lookahead;
 
-  Mark m_mark;
+  // where the next character is; the column is counted from the start of
+  // the line, so eating within a line moves only the position
+  int m_pos = 0;
+  int m_line = 0;
+  int m_lineStart = 0;
   char m_char = Stream::eof();
 
   mutable size_t m_readaheadPos = 0;
@@ -141,23 +194,28 @@ class Stream : private noncopyable {
   CharacterSet m_charSet;
 
   unsigned char* const m_pPrefetched;
+  // The current block: m_pPrefetched, or one owned by m_readAhead
+  mutable const unsigned char* m_pBlock;
   mutable size_t m_nPrefetchedAvailable;
   mutable size_t m_nPrefetchedUsed;
 
-  bool m_ownInput = false;
+  std::unique_ptr<ReadAhead> m_readAhead;
+  mutable InputStats m_stats;
+
+  std::unique_ptr<Transcoder> m_transcoder;
+
   inline void AdvanceCurrent();
   bool ReadAheadTo(size_t i) const;
   bool _ReadAheadTo(size_t i) const;
   void StreamInUtf8() const;
-  void StreamInUtf16() const;
-  void StreamInUtf32() const;
+  void StreamInTranscoded() const;
   unsigned char GetNextByte() const;
-
-  void QueueUnicodeCodepoint(unsigned long ch) const;
+  bool FetchBlock() const;
 
   void UpdateLookahead() const;
 
   static CharacterSet determineCharachterSet(std::istream& input, int& skip);
+  static Transcoder::Encoding TranscoderEncoding(CharacterSet charSet);
 
 };
 
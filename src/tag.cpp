@@ -6,44 +6,75 @@
 #include "token.h"
 
 namespace YAML {
-Tag::Tag(const Token& token) : type(static_cast<TYPE>(token.data)) {
-  switch (type) {
-    case VERBATIM:
-      value = token.value;
-      break;
-    case PRIMARY_HANDLE:
-      value = token.value;
-      break;
-    case SECONDARY_HANDLE:
-      value = token.value;
-      break;
-    case NAMED_HANDLE:
-      handle = token.value;
-      value = (*token.params)[0];
-      break;
-    case NON_SPECIFIC:
-      break;
+namespace {
+const std::string& NoString() {
+  static const std::string none;
+  return none;
+}
+
+const std::string& TagHandle(const Token& token) {
+  return static_cast<Tag::TYPE>(token.data) == Tag::NAMED_HANDLE ? token.value
+                                                                 : NoString();
+}
+
+const std::string& TagValue(const Token& token) {
+  switch (static_cast<Tag::TYPE>(token.data)) {
+    case Tag::VERBATIM:
+    case Tag::PRIMARY_HANDLE:
+    case Tag::SECONDARY_HANDLE:
+      return token.value;
+    case Tag::NAMED_HANDLE:
+      return token.params[0];
+    case Tag::NON_SPECIFIC:
+      return NoString();
     default:
       assert(false);
   }
+  throw std::runtime_error("yaml-cpp: internal error, bad tag type");
 }
+}  // namespace
 
-const std::string Tag::Translate(const Directives& directives) {
+Tag::Tag(const Token& token)
+    : type(static_cast<TYPE>(token.data)),
+      handle(TagHandle(token)),
+      value(TagValue(token)) {}
+
+const std::string& Tag::Translate(const Directives& directives) {
+  static const std::string nonSpecific("!");
+
+  // the handle as it was written, which is all the memo needs to tell tags
+  // apart (verbatim tags have none, and aren't translated)
+  std::string written;
   switch (type) {
     case VERBATIM:
-      return value;
+      break;
     case PRIMARY_HANDLE:
-      return directives.TranslateTagHandle("!") + value;
+      written = "!";
+      break;
     case SECONDARY_HANDLE:
-      return directives.TranslateTagHandle("!!") + value;
+      written = "!!";
+      break;
     case NAMED_HANDLE:
-      return directives.TranslateTagHandle("!" + handle + "!") + value;
+      written = "!" + handle + "!";
+      break;
     case NON_SPECIFIC:
       // TODO:
-      return "!";
+      return nonSpecific;
     default:
       assert(false);
+      throw std::runtime_error("yaml-cpp: internal error, bad tag type");
   }
-  throw std::runtime_error("yaml-cpp: internal error, bad tag type");
+
+  Directives::TranslatedTags& translated = directives.translatedTags[written];
+  Directives::TranslatedTags::const_iterator it = translated.find(value);
+  if (it == translated.end()) {
+    it = translated
+             .emplace(value, written.empty()
+                                 ? value
+                                 : directives.TranslateTagHandle(written) +
+                                       value)
+             .first;
+  }
+  return it->second;
 }
 }
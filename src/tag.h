@@ -15,10 +15,15 @@ struct Tag {
     NON_SPECIFIC
   };
 
+  // the token must outlive the tag
   Tag(const Token& token);
-  const std::string Translate(const Directives& directives);
+
+  // Returns the full tag, which stays valid (and is the same string for the
+  // same handle and suffix) for the life of the directives.
+  const std::string& Translate(const Directives& directives);
 
   TYPE type;
-  std::string handle, value;
+  const std::string& handle;
+  const std::string& value;
 };
 }
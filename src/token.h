@@ -1,6 +1,8 @@
 #pragma once
 
 #include "yaml-cpp/mark.h"
+#include "yaml-cpp/node/detail/string_view.h"
+#include <cstddef>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -13,6 +15,48 @@ const std::string TokenNames[] = {
     "FLOW_MAP_START", "FLOW_SEQ_END", "FLOW_MAP_END", "FLOW_MAP_COMPACT",
     "FLOW_ENTRY", "KEY", "VALUE", "ANCHOR", "ALIAS", "TAG", "SCALAR", "NON_PLAIN_SCALAR"};
 
+/**
+ * The parameters of a directive or tag token. There are rarely more than two,
+ * so those are held in the token itself rather than in a vector of their own.
+ */
+class TokenParams {
+ public:
+  TokenParams() : m_size(0) {}
+
+  std::size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  const std::string& operator[](std::size_t i) const {
+    return i < InlineCount ? m_inline[i] : (*m_more)[i - InlineCount];
+  }
+
+  void clear() {
+    m_size = 0;
+    if (m_more) {
+      m_more->clear();
+    }
+  }
+
+  void push_back(std::string param) {
+    if (m_size < InlineCount) {
+      m_inline[m_size] = std::move(param);
+    } else {
+      if (!m_more) {
+        m_more.reset(new std::vector<std::string>);
+      }
+      m_more->push_back(std::move(param));
+    }
+    m_size++;
+  }
+
+ private:
+  static const std::size_t InlineCount = 2;
+
+  std::size_t m_size;
+  std::string m_inline[InlineCount];
+  std::unique_ptr<std::vector<std::string>> m_more;
+};
+
 struct Token {
   // enums
   enum STATUS : char { VALID, INVALID, UNVERIFIED };
@@ -51,23 +95,32 @@ struct Token {
       : type(type_), status(VALID), data(0), mark(mark_), value(std::move(value_)) {}
 
   friend std::ostream& operator<<(std::ostream& out, const Token& token) {
-    out << TokenNames[token.type] << std::string(": ") << token.value;
-    if (token.params) {
-        for (auto& p : *token.params) {
-            out << std::string(" ") << p;
-        }
+    out << TokenNames[token.type] << std::string(": ");
+    if (token.view.str) {
+      out.write(token.view.str, token.view.length);
+    } else {
+      out << token.value;
+    }
+    for (std::size_t i = 0; i < token.params.size(); i++) {
+      out << std::string(" ") << token.params[i];
     }
     return out;
   }
 
-  void clearParam() {
-    if (params) { params->clear(); }
+  void clearParam() { params.clear(); }
+  void pushParam(std::string param) { params.push_back(std::move(param)); }
+
+  // A scalar read straight from contiguous input refers to it instead of
+  // owning a copy in 'value'.
+  detail::string_view scalar() const {
+    return view.str ? view : detail::string_view{value.data(), value.size()};
   }
-  void pushParam(std::string param) {
-    if (!params) {
-      params = std::unique_ptr<std::vector<std::string>>(new std::vector<std::string>);
+  std::string& ownedValue() {
+    if (view.str) {
+      value.assign(view.str, view.length);
+      view.str = nullptr;
     }
-    params->push_back(std::move(param));
+    return value;
   }
 
   TYPE type;
@@ -75,6 +128,7 @@ struct Token {
   char data;
   Mark mark;
   std::string value;
-  std::unique_ptr<std::vector<std::string>> params;
+  detail::string_view view = {nullptr, 0};
+  TokenParams params;
 };
 }
@@ -0,0 +1,297 @@
+#include "transcoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "stream.h"
+#include "utf8.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define CP_REPLACEMENT_CHARACTER (0xFFFD)
+
+namespace YAML {
+namespace {
+inline char Byte(unsigned long ch) {
+  return static_cast<char>(static_cast<unsigned char>(ch));
+}
+
+inline char* EncodeUtf8(unsigned long ch, char* dst) {
+  // We are not allowed to queue the Stream::eof() codepoint, so
+  // replace it with CP_REPLACEMENT_CHARACTER
+  if (static_cast<unsigned long>(Stream::eof()) == ch) {
+    ch = CP_REPLACEMENT_CHARACTER;
+  }
+
+  if (ch < 0x80) {
+    *dst++ = Byte(ch);
+  } else if (ch < 0x800) {
+    *dst++ = Byte(0xC0 | ((ch >> 6) & 0x1F));
+    *dst++ = Byte(0x80 | (ch & 0x3F));
+  } else if (ch < 0x10000) {
+    *dst++ = Byte(0xE0 | ((ch >> 12) & 0x0F));
+    *dst++ = Byte(0x80 | ((ch >> 6) & 0x3F));
+    *dst++ = Byte(0x80 | (ch & 0x3F));
+  } else {
+    *dst++ = Byte(0xF0 | ((ch >> 18) & 0x07));
+    *dst++ = Byte(0x80 | ((ch >> 12) & 0x3F));
+    *dst++ = Byte(0x80 | ((ch >> 6) & 0x3F));
+    *dst++ = Byte(0x80 | (ch & 0x3F));
+  }
+  return dst;
+}
+
+#if defined(__SSE2__)
+// Converts runs of 8 ASCII code units (other than Stream::eof()) per step.
+// Returns the number of input bytes consumed.
+std::size_t AsciiUtf16(const unsigned char* in, std::size_t size,
+                       bool bigEndian, char*& dst) {
+  const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+  const __m128i eof = _mm_set1_epi16(Stream::eof());
+  const __m128i zero = _mm_setzero_si128();
+
+  std::size_t pos = 0;
+  for (; pos + 16 <= size; pos += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos));
+    if (bigEndian) {
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+    __m128i bad = _mm_or_si128(
+        _mm_cmpeq_epi16(v, eof),
+        _mm_xor_si128(_mm_cmpeq_epi16(_mm_and_si128(v, nonAscii), zero),
+                      _mm_cmpeq_epi16(zero, zero)));
+    if (_mm_movemask_epi8(bad)) {
+      break;
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(v, v));
+    dst += 8;
+  }
+  return pos;
+}
+
+// Same for UTF-32, 4 code units per step.
+std::size_t AsciiUtf32(const unsigned char* in, std::size_t size,
+                       bool bigEndian, char*& dst) {
+  // For big endian input the code point's low byte is the lane's high byte
+  const __m128i nonAscii =
+      _mm_set1_epi32(bigEndian ? static_cast<int>(0x80FFFFFF) : ~0x7F);
+  const __m128i eof = _mm_set1_epi32(bigEndian ? Stream::eof() << 24
+                                               : Stream::eof());
+  const __m128i zero = _mm_setzero_si128();
+
+  std::size_t pos = 0;
+  for (; pos + 16 <= size; pos += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos));
+    __m128i bad = _mm_or_si128(
+        _mm_cmpeq_epi32(v, eof),
+        _mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(v, nonAscii), zero),
+                      _mm_cmpeq_epi32(zero, zero)));
+    if (_mm_movemask_epi8(bad)) {
+      break;
+    }
+    if (bigEndian) {
+      v = _mm_srli_epi32(v, 24);
+    }
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    int packed = _mm_cvtsi128_si32(v);
+    std::memcpy(dst, &packed, 4);
+    dst += 4;
+  }
+  return pos;
+}
+#endif
+}  // namespace
+
+Transcoder::Transcoder(Encoding encoding)
+    : m_unitSize(encoding == utf8
+                     ? 1
+                     : (encoding == utf16le || encoding == utf16be) ? 2 : 4),
+      m_bigEndian(encoding == utf16be || encoding == utf32be),
+      m_partialSize(0),
+      m_highSurrogate(0) {}
+
+unsigned long Transcoder::ReadUnit(const unsigned char* in) const {
+  unsigned long ch = 0;
+  if (m_bigEndian) {
+    for (std::size_t i = 0; i < m_unitSize; i++) {
+      ch = (ch << 8) | in[i];
+    }
+  } else {
+    for (std::size_t i = m_unitSize; i > 0; i--) {
+      ch = (ch << 8) | in[i - 1];
+    }
+  }
+  return ch;
+}
+
+void Transcoder::Append(const unsigned char* in, std::size_t size,
+                        std::vector<char>& out) {
+  // At most 3 bytes of UTF-8 per UTF-16 unit (a surrogate pair is 4 bytes
+  // for 2 units), and 4 per UTF-32 unit. One more unit may be pending in
+  // m_partial, plus a flushed U+FFFD for a dangling high surrogate. Repaired
+  // UTF-8 grows by at most 3 times (every byte replaced by U+FFFD).
+  std::size_t units = (size + m_partialSize) / m_unitSize;
+  std::size_t start = out.size();
+  out.resize(start + (units + 1) * (m_unitSize == 2 ? 3 : 4));
+
+  char* const begin = out.data();
+  char* dst = begin + start;
+  const unsigned char* end = in + size;
+
+  // complete a sequence left over from the previous block
+  while (m_unitSize == 1 && m_partialSize > 0 && in != end) {
+    m_partial[m_partialSize++] = *in++;
+    int length = Utf8::MatchSequence(m_partial, m_partialSize);
+    if (length > 0) {
+      dst = std::copy(m_partial, m_partial + m_partialSize, dst);
+      m_partialSize = 0;
+    } else if (length < 0) {
+      // the new byte broke the sequence, so it starts over on its own
+      dst = EncodeUtf8(CP_REPLACEMENT_CHARACTER, dst);
+      m_partialSize = 0;
+      in--;
+    }
+  }
+
+  // complete a code unit left over from the previous block
+  while (m_unitSize > 1 && m_partialSize > 0 && in != end) {
+    m_partial[m_partialSize++] = *in++;
+    if (m_partialSize == m_unitSize) {
+      m_partialSize = 0;
+      if (m_unitSize == 2) {
+        dst = DecodeUtf16(ReadUnit(m_partial), dst);
+      } else {
+        dst = EncodeUtf8(ReadUnit(m_partial), dst);
+      }
+    }
+  }
+
+  if (m_unitSize == 1) {
+    dst = AppendUtf8(in, end, dst);
+  } else if (m_unitSize == 2) {
+    dst = AppendUtf16(in, end, dst);
+  } else {
+    dst = AppendUtf32(in, end, dst);
+  }
+
+  out.resize(dst - begin);
+}
+
+// AppendUtf8/AppendUtf16/AppendUtf32 return the end of the written output.
+// Any trailing incomplete sequence or code unit is stored in m_partial.
+char* Transcoder::AppendUtf8(const unsigned char* in, const unsigned char* end,
+                             char* dst) {
+  while (in != end) {
+    std::size_t valid =
+        Utf8::ValidPrefix(reinterpret_cast<const char*>(in), end - in);
+    std::memcpy(dst, in, valid);
+    dst += valid;
+    in += valid;
+    if (in == end) {
+      break;
+    }
+
+    int length = Utf8::MatchSequence(in, end - in);
+    if (length == 0) {
+      // cut off by the end of the block
+      break;
+    }
+    dst = EncodeUtf8(CP_REPLACEMENT_CHARACTER, dst);
+    in += -length;
+  }
+
+  for (; in != end; in++) {
+    m_partial[m_partialSize++] = *in;
+  }
+  return dst;
+}
+
+char* Transcoder::AppendUtf16(const unsigned char* in,
+                              const unsigned char* end, char* dst) {
+  while (in != end) {
+#if defined(__SSE2__)
+    if (m_highSurrogate == 0) {
+      in += AsciiUtf16(in, end - in, m_bigEndian, dst);
+    }
+#endif
+    if (end - in < 2) {
+      break;
+    }
+    // scalar steps until the next chance of a vectorized run
+    const unsigned char* stop = in + std::min<std::size_t>((end - in) & ~1, 16);
+    for (; in != stop; in += 2) {
+      dst = DecodeUtf16(ReadUnit(in), dst);
+    }
+  }
+
+  for (; in != end; in++) {
+    m_partial[m_partialSize++] = *in;
+  }
+  return dst;
+}
+
+char* Transcoder::AppendUtf32(const unsigned char* in,
+                              const unsigned char* end, char* dst) {
+  while (in != end) {
+#if defined(__SSE2__)
+    in += AsciiUtf32(in, end - in, m_bigEndian, dst);
+#endif
+    if (end - in < 4) {
+      break;
+    }
+    const unsigned char* stop = in + std::min<std::size_t>((end - in) & ~3, 16);
+    for (; in != stop; in += 4) {
+      dst = EncodeUtf8(ReadUnit(in), dst);
+    }
+  }
+
+  for (; in != end; in++) {
+    m_partial[m_partialSize++] = *in;
+  }
+  return dst;
+}
+
+char* Transcoder::DecodeUtf16(unsigned long ch, char* dst) {
+  if (m_highSurrogate) {
+    unsigned long high = m_highSurrogate;
+    m_highSurrogate = 0;
+
+    if (ch >= 0xDC00 && ch < 0xE000) {
+      // Select the payload bits from the high surrogate, include bits from
+      // the low surrogate and add the surrogacy offset
+      return EncodeUtf8((((high & 0x3FF) << 10) | (ch & 0x3FF)) + 0x10000,
+                        dst);
+    }
+
+    // Trouble...not a low surrogate. Dump a REPLACEMENT CHARACTER into the
+    // stream and deal with this unit on its own.
+    dst = EncodeUtf8(CP_REPLACEMENT_CHARACTER, dst);
+  }
+
+  if (ch >= 0xDC00 && ch < 0xE000) {
+    // Trailing (low) surrogate...ugh, wrong order
+    return EncodeUtf8(CP_REPLACEMENT_CHARACTER, dst);
+  } else if (ch >= 0xD800 && ch < 0xDC00) {
+    // Leading (high) surrogate, wait for the trailing one
+    m_highSurrogate = ch;
+    return dst;
+  }
+
+  return EncodeUtf8(ch, dst);
+}
+
+void Transcoder::Finish(std::vector<char>& out) {
+  bool truncated = m_unitSize == 1 && m_partialSize > 0;
+  m_partialSize = 0;
+  if (m_highSurrogate || truncated) {
+    m_highSurrogate = 0;
+
+    char buffer[4];
+    char* end = EncodeUtf8(CP_REPLACEMENT_CHARACTER, buffer);
+    out.insert(out.end(), buffer, end);
+  }
+}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace YAML {
+/**
+ * Converts UTF-16 or UTF-32 input to UTF-8, or repairs UTF-8 input, a block
+ * of bytes at a time.
+ *
+ * Code units, surrogate pairs and UTF-8 sequences may be split across calls
+ * to {@link Append}; the incomplete tail is kept until the next block
+ * arrives. Malformed surrogates and ill-formed UTF-8 are replaced with
+ * U+FFFD.
+ */
+class Transcoder {
+ public:
+  enum Encoding { utf8, utf16le, utf16be, utf32le, utf32be };
+
+  explicit Transcoder(Encoding encoding);
+
+  /** Appends the UTF-8 encoding of {@code size} input bytes to {@code out}. */
+  void Append(const unsigned char* in, std::size_t size,
+              std::vector<char>& out);
+
+  /**
+   * Ends the input. A dangling high surrogate or a truncated UTF-8 sequence
+   * is flushed as U+FFFD, and an incomplete code unit is dropped.
+   */
+  void Finish(std::vector<char>& out);
+
+ private:
+  char* AppendUtf8(const unsigned char* in, const unsigned char* end,
+                   char* dst);
+  char* AppendUtf16(const unsigned char* in, const unsigned char* end,
+                    char* dst);
+  char* AppendUtf32(const unsigned char* in, const unsigned char* end,
+                    char* dst);
+  char* DecodeUtf16(unsigned long unit, char* dst);
+  unsigned long ReadUnit(const unsigned char* in) const;
+
+  std::size_t m_unitSize;
+  bool m_bigEndian;
+
+  unsigned char m_partial[4];
+  std::size_t m_partialSize;
+  unsigned long m_highSurrogate;
+};
+}
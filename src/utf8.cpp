@@ -0,0 +1,111 @@
+#include "utf8.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace YAML {
+namespace Utf8 {
+namespace {
+bool IsNoncharacter(const unsigned char* in, int length) {
+  unsigned long codePoint;
+  if (length == 3) {
+    codePoint = ((in[0] & 0x0FUL) << 12) | ((in[1] & 0x3FUL) << 6) |
+                (in[2] & 0x3FUL);
+    if (codePoint >= 0xFDD0 && codePoint <= 0xFDEF) {
+      return true;
+    }
+  } else if (length == 4) {
+    codePoint = ((in[0] & 0x07UL) << 18) | ((in[1] & 0x3FUL) << 12) |
+                ((in[2] & 0x3FUL) << 6) | (in[3] & 0x3FUL);
+  } else {
+    return false;
+  }
+  return (codePoint & 0xFFFE) == 0xFFFE;
+}
+}  // namespace
+
+int MatchSequence(const unsigned char* in, std::size_t available,
+                  Noncharacters noncharacters) {
+  const unsigned char lead = in[0];
+  if (lead < 0x80) {
+    return 1;
+  }
+
+  // the range allowed for the second byte depends on the lead byte; all
+  // later bytes are plain continuation bytes
+  int length;
+  unsigned char low = 0x80, high = 0xBF;
+  if (lead < 0xC2) {
+    return -1;
+  } else if (lead < 0xE0) {
+    length = 2;
+  } else if (lead < 0xF0) {
+    length = 3;
+    if (lead == 0xE0) {
+      low = 0xA0;  // overlong
+    } else if (lead == 0xED) {
+      high = 0x9F;  // surrogates
+    }
+  } else if (lead < 0xF5) {
+    length = 4;
+    if (lead == 0xF0) {
+      low = 0x90;  // overlong
+    } else if (lead == 0xF4) {
+      high = 0x8F;  // above U+10FFFF
+    }
+  } else {
+    return -1;
+  }
+
+  for (int i = 1; i < length; i++) {
+    if (static_cast<std::size_t>(i) >= available) {
+      return 0;
+    }
+    if (in[i] < low || in[i] > high) {
+      return -i;
+    }
+    low = 0x80;
+    high = 0xBF;
+  }
+
+  if (noncharacters == RejectNoncharacters && IsNoncharacter(in, length)) {
+    return -length;
+  }
+  return length;
+}
+
+std::size_t ValidPrefix(const char* data, std::size_t size,
+                        Noncharacters noncharacters) {
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+  std::size_t pos = 0;
+
+  while (pos < size) {
+#if defined(__SSE2__)
+    for (; pos + 16 <= size; pos += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos));
+      int mask = _mm_movemask_epi8(v);
+      if (mask) {
+        pos += __builtin_ctz(mask);
+        break;
+      }
+    }
+    if (pos >= size) {
+      break;
+    }
+#endif
+    if (in[pos] < 0x80) {
+      pos++;
+      continue;
+    }
+
+    int length = MatchSequence(in + pos, size - pos, noncharacters);
+    if (length <= 0) {
+      break;
+    }
+    pos += length;
+  }
+  return pos;
+}
+}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+namespace YAML {
+namespace Utf8 {
+enum Noncharacters { AllowNoncharacters, RejectNoncharacters };
+
+/**
+ * Matches one UTF-8 sequence at {@code in}, following the well-formedness
+ * table of the Unicode standard (no overlong forms, no surrogates, nothing
+ * above U+10FFFF).
+ *
+ * @return the length of the sequence; 0 if the bytes are a valid start but
+ *         {@code available} ends early; or minus the length of the maximal
+ *         ill-formed subpart, which should be replaced by a single U+FFFD.
+ */
+int MatchSequence(const unsigned char* in, std::size_t available,
+                  Noncharacters noncharacters = AllowNoncharacters);
+
+/**
+ * Returns the length of the longest prefix of {@code data} that is made of
+ * complete, well-formed UTF-8 sequences. ASCII runs are skipped 16 bytes at a
+ * time.
+ */
+std::size_t ValidPrefix(const char* data, std::size_t size,
+                        Noncharacters noncharacters = AllowNoncharacters);
+
+inline bool IsValid(const char* data, std::size_t size,
+                    Noncharacters noncharacters = AllowNoncharacters) {
+  return ValidPrefix(data, size, noncharacters) == size;
+}
+}
+}
@@ -656,6 +656,17 @@ TEST_F(EmitterTest, DoubleQuotedUnicode) {
   ExpectEmit("\"\x24 \xC2\xA2 \xE2\x82\xAC \xF0\xA4\xAD\xA2\"");
 }
 
+TEST_F(EmitterTest, LiteralUnicode) {
+  out << Literal << "\xE2\x82\xAC\n\xF0\xA4\xAD\xA2";
+  ExpectEmit("|\n  \xE2\x82\xAC\n  \xF0\xA4\xAD\xA2");
+}
+
+TEST_F(EmitterTest, LiteralReplacesNoncharacters) {
+  // U+FFFE is valid UTF-8, but is written as U+FFFD all the same
+  out << Literal << "\xE2\x82\xAC\n\xEF\xBF\xBE";
+  ExpectEmit("|\n  \xE2\x82\xAC\n  \xEF\xBF\xBD");
+}
+
 struct Foo {
   Foo() : x(0) {}
   Foo(int x_, const std::string& bar_) : x(x_), bar(bar_) {}
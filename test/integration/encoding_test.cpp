@@ -1,6 +1,7 @@
 #include <sstream>
 
 #include "handler_test.h"
+#include "yaml-cpp/nodebuilder.h"
 #include "yaml-cpp/yaml.h"  // IWYU pragma: keep
 
 #include "gtest/gtest.h"
@@ -105,6 +106,16 @@ class EncodingTest : public HandlerTest {
     Parse(m_yaml.str());
   }
 
+  // Parses from the in-memory buffer instead of an std::istream
+  void RunBuffer() {
+    std::vector<Node> docs = LoadAll(m_yaml.str());
+    ASSERT_EQ(1, docs.size());
+    ASSERT_EQ(m_entries.size(), docs[0].size());
+    for (std::size_t i = 0; i < m_entries.size(); i++) {
+      EXPECT_EQ(m_entries[i], docs[0][i].as<std::string>());
+    }
+  }
+
  private:
   std::stringstream m_yaml;
   std::vector<std::string> m_entries;
@@ -178,5 +189,111 @@ TEST_F(EncodingTest, UTF32BE_BOM) {
   SetUpEncoding(&EncodeToUtf32BE, true);
   Run();
 }
+
+TEST_F(EncodingTest, UTF16LE_BOM_Buffer) {
+  SetUpEncoding(&EncodeToUtf16LE, true);
+  RunBuffer();
+}
+
+TEST_F(EncodingTest, UTF16BE_noBOM_Buffer) {
+  SetUpEncoding(&EncodeToUtf16BE, false);
+  RunBuffer();
+}
+
+TEST_F(EncodingTest, UTF32LE_noBOM_Buffer) {
+  SetUpEncoding(&EncodeToUtf32LE, false);
+  RunBuffer();
+}
+
+TEST_F(EncodingTest, UTF32BE_BOM_Buffer) {
+  SetUpEncoding(&EncodeToUtf32BE, true);
+  RunBuffer();
+}
+
+TEST(TranscodingTest, MalformedSurrogates) {
+  std::stringstream yaml;
+  EncodeToUtf16LE(yaml, 0xFEFF);
+  for (char ch : std::string("- [")) {
+    EncodeToUtf16LE(yaml, ch);
+  }
+  EncodeToUtf16LE(yaml, 0xDC00);  // lone low surrogate
+  EncodeToUtf16LE(yaml, ',');
+  EncodeToUtf16LE(yaml, 0xD800);  // high surrogate without a low one
+  EncodeToUtf16LE(yaml, 'a');
+  EncodeToUtf16LE(yaml, ']');
+  EncodeToUtf16LE(yaml, '\n');
+  for (char ch : std::string("- x")) {
+    EncodeToUtf16LE(yaml, ch);
+  }
+  EncodeToUtf16LE(yaml, 0xD800);  // dangling at the end of input
+
+  const std::string replacement = "\xEF\xBF\xBD";
+  for (bool buffer : {false, true}) {
+    std::string input = yaml.str();
+    std::stringstream stream(input);
+    Node node = buffer ? Load(input) : Load(stream);
+    ASSERT_TRUE(node.IsSequence());
+    EXPECT_EQ(replacement, node[0][0].as<std::string>());
+    EXPECT_EQ(replacement + "a", node[0][1].as<std::string>());
+    EXPECT_EQ("x" + replacement, node[1].as<std::string>());
+  }
+}
+
+TEST(TranscodingTest, MalformedUtf8) {
+  // a long run first, so that the istream reader sees the bad sequences in
+  // a later block than the first one
+  const std::string padding(10000, 'p');
+  const std::string input = "- " + padding +
+                            "\n"
+                            "- a\xC3(\n"
+                            "- \xE0\x80\x80\n"
+                            "- \xED\xA0\x80\n"
+                            "- \xC3\xA9\n"
+                            "- ok\xE2\x82";
+
+  ParseOptions options;
+  options.repairUtf8 = true;
+
+  // each maximal ill-formed subpart becomes one U+FFFD
+  const std::string replacement = "\xEF\xBF\xBD";
+  for (bool buffer : {false, true}) {
+    std::stringstream stream(input);
+    Node node = buffer ? Load(input.data(), input.size(), options)
+                       : Load(stream, options);
+    ASSERT_TRUE(node.IsSequence());
+    EXPECT_EQ(padding, node[0].as<std::string>());
+    EXPECT_EQ("a" + replacement + "(", node[1].as<std::string>());
+    EXPECT_EQ(replacement + replacement + replacement,
+              node[2].as<std::string>());
+    EXPECT_EQ(replacement + replacement + replacement,
+              node[3].as<std::string>());
+    EXPECT_EQ("\xC3\xA9", node[4].as<std::string>());
+    EXPECT_EQ("ok" + replacement, node[5].as<std::string>());
+  }
+}
+
+TEST(TranscodingTest, Utf8SplitAcrossBlocks) {
+  // three-byte sequences, one of which straddles the istream block size
+  std::string input = "- x";
+  for (int i = 0; i < 3000; i++) {
+    input += "\xE2\x82\xAC";
+  }
+  for (bool repair : {false, true}) {
+    ParseOptions options;
+    options.repairUtf8 = repair;
+    std::stringstream stream(input);
+    Node node = Load(stream, options);
+    EXPECT_EQ(input.substr(2), node[0].as<std::string>());
+  }
+}
+
+TEST(TranscodingTest, IllFormedUtf8PassesThrough) {
+  const std::string input = "a: caf\xE9 \xFF\n";
+  for (bool buffer : {false, true}) {
+    std::stringstream stream(input);
+    Node node = buffer ? Load(input.data(), input.size()) : Load(stream);
+    EXPECT_EQ("caf\xE9 \xFF", node["a"].as<std::string>());
+  }
+}
 }
 }
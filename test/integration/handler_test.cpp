@@ -1,7 +1,11 @@
 #include "handler_test.h"
 #include "specexamples.h"   // IWYU pragma: keep
+#include "yaml-cpp/vieweventhandler.h"
 #include "yaml-cpp/yaml.h"  // IWYU pragma: keep
 
+#include <sstream>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -18,6 +22,106 @@ using ::testing::_;
 namespace YAML {
 namespace {
 
+// Writes each event on a line, so that the two kinds of handler can be
+// compared.
+class RecordingHandler : public EventHandler {
+ public:
+  void OnDocumentStart(const Mark&) override { out << "+doc\n"; }
+  void OnDocumentEnd() override { out << "-doc\n"; }
+  void OnNull(const Mark&, anchor_t anchor) override {
+    out << "null " << anchor << "\n";
+  }
+  void OnAlias(const Mark&, anchor_t anchor) override {
+    out << "alias " << anchor << "\n";
+  }
+  void OnScalar(const Mark&, const std::string& tag, anchor_t anchor,
+                std::string value) override {
+    out << "scalar " << tag << " " << anchor << " " << value << "\n";
+  }
+  void OnSequenceStart(const Mark&, const std::string& tag, anchor_t anchor,
+                       EmitterStyle::value) override {
+    out << "+seq " << tag << " " << anchor << "\n";
+  }
+  void OnSequenceEnd() override { out << "-seq\n"; }
+  void OnMapStart(const Mark&, const std::string& tag, anchor_t anchor,
+                  EmitterStyle::value) override {
+    out << "+map " << tag << " " << anchor << "\n";
+  }
+  void OnMapEnd() override { out << "-map\n"; }
+
+  std::stringstream out;
+};
+
+class RecordingViewHandler : public ViewEventHandler {
+ public:
+  void OnDocumentStart(const Mark&) override { out << "+doc\n"; }
+  void OnDocumentEnd() override { out << "-doc\n"; }
+  void OnNull(const Mark&, anchor_t anchor) override {
+    out << "null " << anchor << "\n";
+  }
+  void OnAlias(const Mark&, anchor_t anchor) override {
+    out << "alias " << anchor << "\n";
+  }
+  void OnScalar(const Mark&, StringView tag, anchor_t anchor,
+                StringView value) override {
+    out << "scalar " << tag.str() << " " << anchor << " " << value.str()
+        << "\n";
+    values.push_back(value.data);
+  }
+  void OnSequenceStart(const Mark&, StringView tag, anchor_t anchor,
+                       EmitterStyle::value) override {
+    out << "+seq " << tag.str() << " " << anchor << "\n";
+  }
+  void OnSequenceEnd() override { out << "-seq\n"; }
+  void OnMapStart(const Mark&, StringView tag, anchor_t anchor,
+                  EmitterStyle::value) override {
+    out << "+map " << tag.str() << " " << anchor << "\n";
+  }
+  void OnMapEnd() override { out << "-map\n"; }
+
+  std::stringstream out;
+  std::vector<const char*> values;
+};
+
+// Reads every event, in the same form as the handlers above.
+std::string ReadEvents(EventReader& reader) {
+  std::stringstream out;
+  Event event;
+  while (reader.Next(event)) {
+    switch (event.type) {
+      case Event::DOCUMENT_START:
+        out << "+doc\n";
+        break;
+      case Event::DOCUMENT_END:
+        out << "-doc\n";
+        break;
+      case Event::NULL_VALUE:
+        out << "null " << event.anchor << "\n";
+        break;
+      case Event::ALIAS:
+        out << "alias " << event.anchor << "\n";
+        break;
+      case Event::SCALAR:
+        out << "scalar " << event.tag.str() << " " << event.anchor << " "
+            << event.value.str() << "\n";
+        break;
+      case Event::SEQUENCE_START:
+        out << "+seq " << event.tag.str() << " " << event.anchor << "\n";
+        break;
+      case Event::SEQUENCE_END:
+        out << "-seq\n";
+        break;
+      case Event::MAP_START:
+        out << "+map " << event.tag.str() << " " << event.anchor << "\n";
+        break;
+      case Event::MAP_END:
+        out << "-map\n";
+        break;
+    }
+  }
+  return out.str();
+}
+
 TEST_F(HandlerTest, NoEndOfMapFlow) {
   EXPECT_THROW_PARSER_EXCEPTION(IgnoreParse("---{header: {id: 1"),
                                 ErrorMsg::END_OF_MAP_FLOW);
@@ -72,5 +176,229 @@ TEST_F(HandlerTest, CommentOnNewlineOfMapValueWithManySpace) {
   EXPECT_CALL(handler, OnDocumentEnd());
   Parse("key: value\n    # comment");
 }
+
+TEST_F(HandlerTest, JsonDocument) {
+  EXPECT_CALL(handler, OnDocumentStart(_));
+  EXPECT_CALL(handler, OnMapStart(_, "?", 0, EmitterStyle::Flow));
+  EXPECT_CALL(handler, OnScalar(_, "!", 0, "a"));
+  EXPECT_CALL(handler, OnSequenceStart(_, "?", 0, EmitterStyle::Flow));
+  EXPECT_CALL(handler, OnScalar(_, "?", 0, "-1.5e3"));
+  EXPECT_CALL(handler, OnScalar(_, "?", 0, "true"));
+  EXPECT_CALL(handler, OnNull(_, 0));
+  EXPECT_CALL(handler, OnScalar(_, "!", 0, "x\"/\n\xC3\xA9"));
+  EXPECT_CALL(handler, OnMapStart(_, "?", 0, EmitterStyle::Flow));
+  EXPECT_CALL(handler, OnMapEnd());
+  EXPECT_CALL(handler, OnSequenceEnd());
+  EXPECT_CALL(handler, OnScalar(_, "!", 0, "b"));
+  EXPECT_CALL(handler, OnSequenceStart(_, "?", 0, EmitterStyle::Flow));
+  EXPECT_CALL(handler, OnSequenceEnd());
+  EXPECT_CALL(handler, OnMapEnd());
+  EXPECT_CALL(handler, OnDocumentEnd());
+
+  const std::string input =
+      " {\"a\": [-1.5e3, true, null, \"x\\\"\\/\\n\\u00e9\", {}],\n"
+      "  \"b\":[]}\n";
+  Parser parser(input);
+  while (parser.HandleNextDocument(handler)) {
+  }
+}
+
+TEST_F(HandlerTest, JsonDocumentKeepsMarks) {
+  // the first is read as JSON, the second (with a comment) as YAML
+  const std::string inputs[] = {"[\"a\",\n  {\"b\": [1, \"c\"]}]",
+                                "[\"a\",\n  {\"b\": [1, \"c\"]}] # x"};
+  for (const std::string& input : inputs) {
+    Node node = Load(input);
+    EXPECT_EQ("c", node[1]["b"][1].as<std::string>());
+    EXPECT_EQ(1, node[1].Mark().line);
+    EXPECT_EQ(2, node[1].Mark().column);
+    EXPECT_EQ(1, node[1]["b"][1].Mark().line);
+    EXPECT_EQ(12, node[1]["b"][1].Mark().column);
+  }
+}
+
+TEST_F(HandlerTest, UntrackedMarksAreOffsets) {
+  ParseOptions options;
+  options.trackMarks = false;
+
+  const std::string json = "[\"a\",\n  {\"b\": [1, \"c\"]}]";
+  Node node = Load(json.data(), json.size(), options);
+  EXPECT_EQ("c", node[1]["b"][1].as<std::string>());
+  EXPECT_TRUE(node[1].Mark().is_offset_only());
+  EXPECT_EQ(8, node[1].Mark().pos);
+  EXPECT_EQ(18, node[1]["b"][1].Mark().pos);
+
+  // YAML (here, because of the comment) is read with lines all the same
+  const std::string yaml = json + " # x";
+  Node yamlNode = Load(yaml.data(), yaml.size(), options);
+  EXPECT_EQ(1, yamlNode[1]["b"][1].Mark().line);
+  EXPECT_EQ(12, yamlNode[1]["b"][1].Mark().column);
+
+  const std::string bad = "a: 1\nb: [c,\n";
+  try {
+    Load(bad.data(), bad.size(), options);
+    FAIL() << "expected a ParserException";
+  } catch (const ParserException& e) {
+    EXPECT_FALSE(e.mark.is_offset_only());
+  }
+}
+
+TEST_F(HandlerTest, JsonLikeDocumentFallsBackToYaml) {
+  // a trailing comma is not JSON, but is fine in a YAML flow sequence
+  EXPECT_CALL(handler, OnDocumentStart(_));
+  EXPECT_CALL(handler, OnSequenceStart(_, "?", 0, EmitterStyle::Flow));
+  EXPECT_CALL(handler, OnScalar(_, "?", 0, "1"));
+  EXPECT_CALL(handler, OnScalar(_, "?", 0, "two"));
+  EXPECT_CALL(handler, OnSequenceEnd());
+  EXPECT_CALL(handler, OnDocumentEnd());
+
+  const std::string input = "[1, two,]";
+  Parser parser(input);
+  while (parser.HandleNextDocument(handler)) {
+  }
+}
+
+TEST_F(HandlerTest, MultiLineFlowIsHandledAsItIsScanned) {
+  // a flow sequence spread over lines can't be a simple key, so its entries
+  // are handled before the error further on is scanned
+  EXPECT_CALL(handler, OnDocumentStart(_));
+  EXPECT_CALL(handler, OnSequenceStart(_, "?", 0, EmitterStyle::Flow));
+  EXPECT_CALL(handler, OnScalar(_, "?", 0, "a"));
+  EXPECT_CALL(handler, OnScalar(_, "?", 0, "b"));
+
+  try {
+    Parse("[a,\n b,\n}");
+    FAIL() << "expected a ParserException";
+  } catch (const ParserException& e) {
+    EXPECT_EQ(ErrorMsg::FLOW_END, e.msg);
+  }
+}
+
+TEST_F(HandlerTest, StrayFlowEntryAfterDocument) {
+  // the "," can't start a node, so the second document can't get past it
+  EXPECT_CALL(handler, OnDocumentStart(_));
+  EXPECT_CALL(handler, OnSequenceStart(_, "?", 0, EmitterStyle::Flow));
+  EXPECT_CALL(handler, OnSequenceEnd());
+  EXPECT_CALL(handler, OnDocumentEnd());
+  EXPECT_CALL(handler, OnDocumentStart(_));
+  EXPECT_CALL(handler, OnNull(_, 0));
+
+  try {
+    Parse("[],[\n");
+    FAIL() << "expected a ParserException";
+  } catch (const ParserException& e) {
+    EXPECT_EQ(ErrorMsg::UNKNOWN_TOKEN, e.msg);
+  }
+  EXPECT_THROW(LoadAll("[],[\n"), ParserException);
+}
+
+TEST_F(HandlerTest, ViewHandlerSeesTheSameEvents) {
+  const std::string inputs[] = {
+      "{\"a\": [1, \"b\\n\", null], \"c\": {}}",
+      "%TAG !e! tag:example.com,2000:\n--- !e!m\n"
+      "&x a: [b, 'c', \"d\\t\", !!str e, ~, *x]\n"
+      "? |\n  f\n  g\n:\n...\n--- h\n",
+      "[a, {b: c}, d: e, : f]"};
+  for (const std::string& input : inputs) {
+    RecordingHandler expected;
+    Parser parser(input.data(), input.size());
+    while (parser.HandleNextDocument(expected)) {
+    }
+
+    RecordingViewHandler actual;
+    parser.Load(input.data(), input.size());
+    while (parser.HandleNextDocument(actual)) {
+    }
+    EXPECT_EQ(expected.out.str(), actual.out.str());
+  }
+}
+
+TEST_F(HandlerTest, ViewHandlerScalarsPointIntoTheInput) {
+  // a plain scalar with no line breaks, and a JSON string with no escapes,
+  // are given as they are in the input
+  const std::string inputs[] = {"a: bcd", "{\"a\": \"bcd\"}"};
+  for (const std::string& input : inputs) {
+    RecordingViewHandler handler;
+    Parser parser(input.data(), input.size());
+    while (parser.HandleNextDocument(handler)) {
+    }
+    ASSERT_EQ(2, handler.values.size());
+    EXPECT_EQ(input.find("bcd"), handler.values[1] - input.data());
+  }
+}
+
+TEST_F(HandlerTest, EventReaderSeesTheSameEvents) {
+  const std::string inputs[] = {
+      "{\"a\": [1, \"b\\n\", null], \"c\": {}}",
+      "%TAG !e! tag:example.com,2000:\n--- !e!m\n"
+      "&x a: [b, 'c', \"d\\t\", !!str e, ~, *x]\n"
+      "? |\n  f\n  g\n:\n...\n--- h\n",
+      "[a, {b: c}, d: e, : f]\n---\n- - x\n  -\n- y: z\n  :\n"};
+  for (const std::string& input : inputs) {
+    RecordingHandler expected;
+    Parser parser(input.data(), input.size());
+    while (parser.HandleNextDocument(expected)) {
+    }
+
+    EventReader reader(input.data(), input.size());
+    EXPECT_EQ(expected.out.str(), ReadEvents(reader));
+  }
+}
+
+TEST_F(HandlerTest, EventReaderSkipsValues) {
+  const std::string input =
+      "a: &x {b: [1, {c: d}], e: f}\ng: [h]\ni: *x\n--- [j]\n--- k\n";
+  EventReader reader(input.data(), input.size());
+  Event event;
+
+  ASSERT_TRUE(reader.Next(event));
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ(Event::MAP_START, event.type);
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ("a", event.value);
+  reader.SkipValue();
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ("g", event.value);
+  reader.SkipValue();
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ("i", event.value);
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ(Event::ALIAS, event.type);
+  EXPECT_EQ(1, event.anchor);
+
+  // there's nothing to skip at the end of a map
+  reader.SkipValue();
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ(Event::MAP_END, event.type);
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ(Event::DOCUMENT_END, event.type);
+
+  // but a whole document can be skipped
+  reader.SkipValue();
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ(Event::DOCUMENT_START, event.type);
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_EQ("k", event.value);
+  ASSERT_TRUE(reader.Next(event));
+  EXPECT_FALSE(reader.Next(event));
+  reader.SkipValue();
+}
+
+TEST_F(HandlerTest, EventReaderStopsEarly) {
+  // the error further on is never reached
+  const std::string input = "a: 1\nb: [c,\n";
+  EventReader reader(input.data(), input.size());
+  Event event;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(reader.Next(event));
+  }
+  EXPECT_EQ(Event::SCALAR, event.type);
+  EXPECT_EQ("1", event.value);
+  EXPECT_EQ(0, event.mark.line);
+  EXPECT_EQ(3, event.mark.column);
+
+  reader.SkipValue();
+  EXPECT_THROW(reader.SkipValue(), ParserException);
+}
 }  // namespace
 }  // namespace YAML
@@ -1,5 +1,12 @@
+#include "yaml-cpp/nodebuilder.h"
 #include "yaml-cpp/yaml.h"  // IWYU pragma: keep
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 namespace YAML {
@@ -196,6 +203,470 @@ TEST(LoadNodeTest, EmptyString) {
   EXPECT_TRUE(!node.IsNull());
 }
 
+TEST(LoadNodeTest, LoadBuffer) {
+  // Only the first 'size' bytes belong to the document
+  const char buffer[] = "[a, b]: c\ngarbage: {";
+  Node node = Load(buffer, 9);
+  ASSERT_TRUE(node.IsMap());
+  EXPECT_EQ(1, node.size());
+  EXPECT_EQ("c", node.begin()->second.as<std::string>());
+}
+
+TEST(LoadNodeTest, LoadAllBuffer) {
+  const char buffer[] = "--- a\n--- b\n--- {";
+  std::vector<Node> docs = LoadAll(buffer, 12);
+  ASSERT_EQ(2, docs.size());
+  EXPECT_EQ("a", docs[0].as<std::string>());
+  EXPECT_EQ("b", docs[1].as<std::string>());
+
+  EXPECT_TRUE(LoadAll(buffer, 0).empty());
+}
+
+// Many small documents, of every kind that has to be told apart from the
+// "---" lines between them
+std::string ManyDocuments(int count) {
+  std::stringstream input;
+  for (int i = 0; i < count; i++) {
+    input << "--- # " << i << "\n"
+          << "id: &id " << i << "\n"
+          << "text: |\n  line one ---\n  line two\n"
+          << "quoted: \"a\n  b\"\n"
+          << "flow: [*id, {k: v}]\n";
+    if (i % 7 == 0) {
+      input << "...\n# between\n";
+    }
+  }
+  return input.str();
+}
+
+TEST(LoadNodeTest, LoadAllInParallel) {
+  const std::string input = ManyDocuments(4000);
+  std::vector<Node> serial = LoadAll(input.data(), input.size());
+
+  ParseOptions options;
+  options.threads = 4;
+  std::vector<Node> docs = LoadAll(input.data(), input.size(), options);
+  ASSERT_EQ(serial.size(), docs.size());
+  for (std::size_t i = 0; i < docs.size(); i += 333) {
+    EXPECT_EQ(Dump(serial[i]), Dump(docs[i]));
+    EXPECT_EQ(static_cast<int>(i), docs[i]["flow"][0].as<int>());
+    EXPECT_EQ(serial[i]["quoted"].Mark().pos, docs[i]["quoted"].Mark().pos);
+    EXPECT_EQ(serial[i]["quoted"].Mark().line,
+              docs[i]["quoted"].Mark().line);
+    EXPECT_EQ(8, docs[i]["quoted"].Mark().column);
+  }
+}
+
+TEST(LoadNodeTest, LoadAllInParallelKeepsDirectives) {
+  // a directive holds for the documents after it, so they're read in turn
+  const std::string input =
+      "%TAG !e! tag:example.com,2000:\n" + ManyDocuments(4000) + "--- !e!x y\n";
+  ParseOptions options;
+  options.threads = 4;
+  std::vector<Node> docs = LoadAll(input.data(), input.size(), options);
+  ASSERT_EQ(4001, docs.size());
+  EXPECT_EQ("tag:example.com,2000:x", docs.back().Tag());
+}
+
+TEST(LoadNodeTest, LoadAllInParallelThrowsTheSerialError) {
+  // read on its own, the document with the unclosed quote would end before
+  // the "---" that ends it when the input is read as a whole
+  std::string input = ManyDocuments(4000);
+  input.insert(input.find("---", input.size() / 2), "--- \"a\n");
+
+  ParseOptions options;
+  options.threads = 4;
+  Mark expected;
+  try {
+    LoadAll(input.data(), input.size());
+    FAIL() << "expected a ParserException";
+  } catch (const ParserException& e) {
+    expected = e.mark;
+  }
+  try {
+    LoadAll(input.data(), input.size(), options);
+    FAIL() << "expected a ParserException";
+  } catch (const ParserException& e) {
+    EXPECT_EQ(expected.pos, e.mark.pos);
+    EXPECT_EQ(expected.line, e.mark.line);
+  }
+}
+
+// Many entries of a root sequence or mapping, of every kind that has to be
+// told apart from the lines that start an entry
+std::string ManyEntries(int count, bool sequence) {
+  std::stringstream input;
+  for (int i = 0; i < count; i++) {
+    if (sequence) {
+      input << "- id: &id " << i << "\n"
+            << "  text: |\n    - not an entry\n"
+            << "  quoted: \"a\n  b\"\n"
+            << "  ref: *id\n"
+            << "- [x, y]\n";
+    } else {
+      input << "key" << i << ":\n"
+            << "  id: &id " << i << "\n"
+            << "  text: |\n    key: not an entry\n"
+            << "  quoted: \"a\n  b\"\n"
+            << "  ref: *id\n"
+            << "list" << i << ":\n- a\n- [x, y]\n";
+    }
+    if (i % 7 == 0) {
+      input << "# between\n\n";
+    }
+  }
+  return input.str();
+}
+
+TEST(LoadNodeTest, LoadInParallel) {
+  for (bool sequence : {true, false}) {
+    const std::string input =
+        "# header\n--- !root\n" + ManyEntries(4000, sequence);
+    const Node serial = Load(input.data(), input.size());
+
+    ParseOptions options;
+    options.threads = 4;
+    const Node doc = Load(input.data(), input.size(), options);
+    EXPECT_EQ(Dump(serial), Dump(doc));
+    EXPECT_EQ(8000, doc.size());
+    EXPECT_EQ("!root", doc.Tag());
+    for (int i = 0; i < 4000; i += 333) {
+      const Node entry = sequence ? doc[2 * i] : doc["key" + std::to_string(i)];
+      const Node expected =
+          sequence ? serial[2 * i] : serial["key" + std::to_string(i)];
+      EXPECT_EQ(expected["quoted"].Mark().pos, entry["quoted"].Mark().pos);
+      EXPECT_EQ(expected["quoted"].Mark().line, entry["quoted"].Mark().line);
+      EXPECT_EQ(10, entry["quoted"].Mark().column);
+      EXPECT_EQ(i, entry["ref"].as<int>());
+    }
+  }
+}
+
+TEST(LoadNodeTest, LoadInParallelChecksTheSplit) {
+  // an alias to an anchor far back, and a quoted scalar over what look like
+  // entries, are only read right when the input is read as a whole
+  const std::string input = "first: &first a\n" + ManyEntries(2000, false) +
+                            "open: '" + ManyEntries(2000, false) +
+                            "'\nlast: *first\n";
+  const Node serial = Load(input.data(), input.size());
+
+  ParseOptions options;
+  options.threads = 4;
+  const Node doc = Load(input.data(), input.size(), options);
+  EXPECT_EQ(Dump(serial), Dump(doc));
+  EXPECT_EQ("a", doc["last"].as<std::string>());
+  EXPECT_EQ(4003, doc.size());
+}
+
+TEST(LoadNodeTest, LoadLargeStream) {
+  // Spans many prefetch blocks, with scalars straddling block boundaries
+  std::stringstream input;
+  for (int i = 0; i < 5000; i++) {
+    input << "key" << i << ": \"value " << i << "\" # comment\n";
+  }
+  Node node = Load(input);
+  ASSERT_TRUE(node.IsMap());
+  EXPECT_EQ(5000, node.size());
+  EXPECT_EQ("value 0", node["key0"].as<std::string>());
+  EXPECT_EQ("value 2718", node["key2718"].as<std::string>());
+  EXPECT_EQ("value 4999", node["key4999"].as<std::string>());
+}
+
+TEST(LoadNodeTest, PlainScalarRuns) {
+  Node node = Load(
+      "url: http://example.com/a#b:c  # comment\n"
+      "text: one two\tthree   \n"
+      "folded: first line\n  second line\n"
+      "flow: [a b, c#d, e:f, {g h: i j}]\n");
+  EXPECT_EQ("http://example.com/a#b:c", node["url"].as<std::string>());
+  EXPECT_EQ("one two\tthree", node["text"].as<std::string>());
+  EXPECT_EQ("first line second line", node["folded"].as<std::string>());
+  EXPECT_EQ("a b", node["flow"][0].as<std::string>());
+  EXPECT_EQ("c#d", node["flow"][1].as<std::string>());
+  EXPECT_EQ("e:f", node["flow"][2].as<std::string>());
+  EXPECT_EQ("i j", node["flow"][3]["g h"].as<std::string>());
+}
+
+TEST(LoadNodeTest, BorrowedScalarsOutliveInput) {
+  std::vector<char> input;
+  const std::string text =
+      "key  : value \t # comment\n"
+      "next: 'single' \n"
+      "more: \"double\"\n"
+      "tabbed: end\t\n"
+      "  folded\n"
+      "seq:\n"
+      "- item \t\n"
+      "- 'it''s'\n"
+      "- \"esc\\taped\"\n"
+      "- ~\n"
+      "last: tail\t";
+  input.assign(text.begin(), text.end());
+
+  Node node = Load(input.data(), input.size());
+  std::fill(input.begin(), input.end(), 'x');
+
+  EXPECT_EQ("value \t", node["key"].as<std::string>());
+  EXPECT_EQ("single", node["next"].as<std::string>());
+  EXPECT_EQ("double", node["more"].as<std::string>());
+  EXPECT_EQ("end folded", node["tabbed"].as<std::string>());
+  EXPECT_EQ("item", node["seq"][0].as<std::string>());
+  EXPECT_EQ("it's", node["seq"][1].as<std::string>());
+  EXPECT_EQ("esc\taped", node["seq"][2].as<std::string>());
+  EXPECT_TRUE(node["seq"][3].IsNull());
+  EXPECT_EQ("tail\t", node["last"].as<std::string>());
+}
+
+TEST(LoadNodeTest, ManyTokensWaitingOnSimpleKeys) {
+  // every entry here could still turn out to be (part of) a simple key, so
+  // they are all held back until the end of the line
+  std::string line = "[";
+  for (int i = 0; i < 300; i++) {
+    line += (i ? ", {" : "{") + std::to_string(i) + "}";
+  }
+  line += "]";
+  const std::string input = "key: " + line + "\nother: " + line + "\n";
+
+  Node node = Load(input);
+  ASSERT_EQ(300, node["key"].size());
+  EXPECT_TRUE(node["key"][299]["299"].IsNull());
+  EXPECT_EQ(300, node["other"].size());
+}
+
+TEST(LoadNodeTest, ManyAnchorsAndAliases) {
+  std::string input;
+  for (int i = 0; i < 500; i++) {
+    input += "- &a" + std::to_string(i) + " " + std::to_string(i) + "\n";
+  }
+  // redefining an anchor affects only the aliases that follow it
+  input += "- *a7\n- &a7 seven\n- *a7\n- [*a499, *a0]\n";
+
+  Node node = Load(input);
+  ASSERT_EQ(504, node.size());
+  EXPECT_EQ(7, node[500].as<int>());
+  EXPECT_EQ("seven", node[502].as<std::string>());
+  EXPECT_EQ(499, node[503][0].as<int>());
+  EXPECT_EQ(0, node[503][1].as<int>());
+
+  EXPECT_THROW(Load("- &a1 x\n- *a\n"), ParserException);
+}
+
+TEST(LoadNodeTest, EqualTagsAreShared) {
+  Node node = Load(
+      "%TAG !e! tag:example.com,2000:app/\n"
+      "---\n"
+      "- !e!secret a\n"
+      "- !e!secret b\n"
+      "- !<tag:example.com,2000:app/secret> c\n"
+      "- !!str d\n"
+      "- !!str e\n"
+      "- !local f\n");
+  EXPECT_EQ("tag:example.com,2000:app/secret", node[0].Tag());
+  EXPECT_EQ(&node[0].Tag(), &node[1].Tag());
+  EXPECT_EQ(&node[0].Tag(), &node[2].Tag());
+  EXPECT_EQ("tag:yaml.org,2002:str", node[3].Tag());
+  EXPECT_EQ(&node[3].Tag(), &node[4].Tag());
+  EXPECT_EQ("!local", node[5].Tag());
+
+  node[4].SetTag("!local");
+  EXPECT_EQ(&node[5].Tag(), &node[4].Tag());
+
+  // another document has tags of its own, which come along when it is
+  // merged in
+  const std::string* tag;
+  {
+    Node other = Load("!!str x");
+    EXPECT_EQ(node[3].Tag(), other.Tag());
+    tag = &other.Tag();
+    node.push_back(other);
+  }
+  EXPECT_EQ(tag, &node[6].Tag());
+  EXPECT_EQ("tag:yaml.org,2002:str", node[6].Tag());
+}
+
+TEST(LoadNodeTest, MarksSurviveMergingDocuments) {
+  Node a = Load("x: 1\ny:\n  - 2\n  - &z three\n  - *z\n");
+  Node b = Load("# comment\n\n   [4, {five: 6}]\n");
+
+  Node combined;
+  combined["a"] = a;
+  combined["b"] = b;
+  combined["c"] = Load("seven");
+
+  const Mark y = combined["a"]["y"][1].Mark();
+  EXPECT_EQ(18, y.pos);
+  EXPECT_EQ(3, y.line);
+  EXPECT_EQ(4, y.column);
+  EXPECT_EQ(y.pos, combined["a"]["y"][2].Mark().pos);
+
+  const Mark six = combined["b"][1]["five"].Mark();
+  EXPECT_EQ(25, six.pos);
+  EXPECT_EQ(2, six.line);
+  EXPECT_EQ(14, six.column);
+
+  EXPECT_EQ(0, combined["c"].Mark().line);
+  EXPECT_TRUE(combined["d"].Mark().is_null());
+}
+
+TEST(LoadNodeTest, MarksSurviveMergingManyDocuments) {
+  // each document brings a line table of its own
+  Node combined;
+  for (int i = 0; i < 300; i++) {
+    combined.push_back(Load("x: 1\ny: 2\nz:    3\n"));
+  }
+
+  for (std::size_t i = 0; i < combined.size(); i++) {
+    const Mark z = combined[i]["z"].Mark();
+    EXPECT_EQ(2, z.line);
+    EXPECT_EQ(6, z.column);
+  }
+}
+
+TEST(LoadNodeTest, MarksSurviveChainedMerges) {
+  // bc keeps the memory that b had before it merged into a, and a's memory
+  // goes on to merge into c's
+  Node a = Load("a: 1");
+  Node b = Load("\n\nb: 2");
+  Node bc = b["b"];
+  a["x"] = b;
+  Node c = Load("c: 3");
+  c["y"] = a;
+
+  const Mark mark = bc.Mark();
+  EXPECT_EQ(2, mark.line);
+  EXPECT_EQ(3, mark.column);
+}
+
+TEST(LoadNodeTest, WhitespaceAndCommentRuns) {
+  std::string indent(40, ' ');
+  Node node = Load("# header comment with some length to it\r\n"
+                   "a:" + indent + "\t  # comment\n"
+                   "  b:\t \t c   d\n"
+                   "      e     # trailing\n"
+                   "  f: >\n"
+                   "      folded\n"
+                   "       more\n"
+                   "     \n"
+                   "      end\n"
+                   "  g: |2\n"
+                   "      kept  # not a comment\n");
+  EXPECT_EQ("c   d e", node["a"]["b"].as<std::string>());
+  EXPECT_EQ("folded\n more\n\nend\n", node["a"]["f"].as<std::string>());
+  EXPECT_EQ("  kept  # not a comment\n", node["a"]["g"].as<std::string>());
+}
+
+TEST(LoadNodeTest, QuotedScalarRuns) {
+  Node node = Load(
+      "single: 'it''s a long, plain # run: [x]'\n"
+      "double: \"tab\\there \\u00e9 \\\"quoted\\\" a#b: c\"\n"
+      "folded: \"first   \n   second\\\n   third\n\n   fourth\"\n");
+  EXPECT_EQ("it's a long, plain # run: [x]", node["single"].as<std::string>());
+  EXPECT_EQ("tab\there \xC3\xA9 \"quoted\" a#b: c",
+            node["double"].as<std::string>());
+  EXPECT_EQ("first secondthird\nfourth", node["folded"].as<std::string>());
+}
+
+TEST(LoadNodeTest, BlockScalarLines) {
+  Node node = Load(
+      "literal: |\n"
+      "  first line: with # and [x]\n"
+      "\n"
+      "    more indented\n"
+      "  last\n"
+      "\n"
+      "\n"
+      "folded: >-\n"
+      "  one\n"
+      "  two\n"
+      "\n"
+      "    three\n"
+      "  four\n"
+      "kept: |+\n"
+      "  text\n"
+      "\n");
+  EXPECT_EQ("first line: with # and [x]\n\n  more indented\nlast\n",
+            node["literal"].as<std::string>());
+  EXPECT_EQ("one two\n\n  three\nfour", node["folded"].as<std::string>());
+  EXPECT_EQ("text\n\n", node["kept"].as<std::string>());
+}
+
+TEST(LoadNodeTest, LoadStreamWithBackgroundReadAhead) {
+  std::stringstream input;
+  for (int i = 0; i < 20000; i++) {
+    input << "key" << i << ": [" << i << ", \"value " << i << "\"]\n";
+  }
+  const std::string::size_type size = input.str().size();
+
+  ParseOptions options;
+  options.backgroundReadAhead = true;
+  Parser parser(input, options);
+  NodeBuilder builder;
+  ASSERT_TRUE(parser.HandleNextDocument(builder));
+  Node node = builder.Root();
+  ASSERT_TRUE(node.IsMap());
+  EXPECT_EQ(20000, node.size());
+  EXPECT_EQ("value 19999", node["key19999"][1].as<std::string>());
+
+  InputStats stats = parser.GetInputStats();
+  EXPECT_EQ(size, stats.bytesRead);
+  EXPECT_LT(0, stats.blocksRead);
+  EXPECT_FALSE(parser.HandleNextDocument(builder));
+}
+
+TEST(LoadNodeTest, LoadStreamCountsStalls) {
+  std::stringstream input("a: 1\n---\nb: 2\n");
+  Parser parser(input);
+  NodeBuilder builder;
+  ASSERT_TRUE(parser.HandleNextDocument(builder));
+
+  InputStats stats = parser.GetInputStats();
+  EXPECT_EQ(input.str().size(), stats.bytesRead);
+  EXPECT_EQ(1, stats.blocksRead);
+  EXPECT_LE(1, stats.stalls);
+}
+
+TEST(LoadNodeTest, LoadAllStreamWithBackgroundReadAhead) {
+  // UTF-16LE, which the background reader hands to the transcoder
+  const char data[] = "\xFF\xFE" "a\0:\0 \0b\0\n\0-\0-\0-\0\n\0c\0\n\0";
+  std::stringstream input(std::string(data, sizeof(data) - 1));
+  ParseOptions options;
+  options.backgroundReadAhead = true;
+  std::vector<Node> docs = LoadAll(input, options);
+  ASSERT_EQ(2, docs.size());
+  EXPECT_EQ("b", docs[0]["a"].as<std::string>());
+  EXPECT_EQ("c", docs[1].as<std::string>());
+}
+
+TEST(LoadNodeTest, LoadFile) {
+  const char* filename = "yaml-cpp-load-file-test.yaml";
+  {
+    std::ofstream out(filename);
+    out << "foo: bar\nlist: [1, 2, 3]\n---\nsecond\n";
+  }
+  Node node = LoadFile(filename);
+  EXPECT_EQ("bar", node["foo"].as<std::string>());
+  EXPECT_EQ(3, node["list"][2].as<int>());
+
+  std::vector<Node> docs = LoadAllFromFile(filename);
+  ASSERT_EQ(2, docs.size());
+  EXPECT_EQ("bar", docs[0]["foo"].as<std::string>());
+  EXPECT_EQ("second", docs[1].as<std::string>());
+  std::remove(filename);
+}
+
+TEST(LoadNodeTest, LoadEmptyFile) {
+  const char* filename = "yaml-cpp-load-empty-file-test.yaml";
+  { std::ofstream out(filename); }
+  EXPECT_TRUE(LoadFile(filename).IsNull());
+  EXPECT_TRUE(LoadAllFromFile(filename).empty());
+  std::remove(filename);
+}
+
+TEST(LoadNodeTest, LoadMissingFile) {
+  EXPECT_THROW(LoadFile("yaml-cpp-no-such-file.yaml"), BadFile);
+  EXPECT_THROW(LoadAllFromFile("yaml-cpp-no-such-file.yaml"), BadFile);
+}
+
 TEST(LoadNodeTest, DereferenceIteratorError) {
   Node node = Load("[{a: b}, 1, 2]");
   EXPECT_THROW(node.begin()->first.as<int>(), InvalidNode);
@@ -246,6 +717,11 @@ TEST(NodeTest, IncompleteJson) {
   }
 }
 
+TEST(NodeTest, UnclosedQuoteAtEndOfInput) {
+  EXPECT_THROW(Load("a: \"b\n"), ParserException);
+  EXPECT_THROW(Load("- 'b\n  c\n"), ParserException);
+}
+
 TEST(NodeTest, LoadTildeAsNull) {
   Node node = Load("~");
   ASSERT_TRUE(node.IsNull());
@@ -577,6 +577,23 @@ TEST(NodeTest, ChildNodesAliveAfterOwnerNodeExitsScope) {
   EXPECT_EQ(node["Message"]["Hello"].Scalar(), "World");
 }
 
+TEST(NodeTest, ManyChildrenFromOtherNodes) {
+  // each child brings its own memory along, in among the parent's nodes
+  Node node;
+  for (int i = 0; i < 20000; i++) {
+    Node child;
+    child["id"] = i;
+    node.push_back(child);
+    node.push_back(i);
+  }
+
+  ASSERT_EQ(40000, node.size());
+  for (int i = 0; i < 20000; i += 997) {
+    EXPECT_EQ(i, node[2 * i]["id"].as<int>());
+    EXPECT_EQ(i, node[2 * i + 1].as<int>());
+  }
+}
+
 TEST(NodeTest, AdvancedMemoryMerging) {
 
   {
@@ -233,4 +233,22 @@ TEST(RegExTest, StringOr) {
 
   EXPECT_EQ(1, ex::Match(str));
 }
+
+TEST(RegExTest, OperatorOrOfClassesAndSequences) {
+  // the single characters before and after the sequence are tested as
+  // separate classes; order and match lengths are unchanged
+  using ex = Matcher<OR<Char<'a'>, Range<'0', '9'>, SEQ<Char<'\r'>, Char<'\n'>>,
+                        Range<'\x80', '\xBF'>, NOT<OR<Char<'x'>, BlankT>>>>;
+
+  EXPECT_EQ(1, ex::Match(std::string("a")));
+  EXPECT_EQ(1, ex::Match(std::string("7")));
+  EXPECT_EQ(2, ex::Match(std::string("\r\n")));
+  EXPECT_EQ(1, ex::Match(std::string("\r")));
+  EXPECT_EQ(1, ex::Match(std::string("\x80")));
+  EXPECT_EQ(1, ex::Match(std::string("\xFF")));
+  EXPECT_EQ(1, ex::Match(std::string("y")));
+  EXPECT_EQ(-1, ex::Match(std::string("x")));
+  EXPECT_EQ(-1, ex::Match(std::string(" ")));
+  EXPECT_EQ(-1, ex::Match(std::string("\t")));
+}
 }
@@ -1,12 +1,12 @@
 #include "yaml-cpp/emitterstyle.h"
-#include "yaml-cpp/eventhandler.h"
+#include "yaml-cpp/vieweventhandler.h"
 #include "yaml-cpp/yaml.h"  // IWYU pragma: keep
 
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 
-class NullEventHandler : public YAML::EventHandler {
+class NullEventHandler : public YAML::ViewEventHandler {
  public:
   typedef YAML::Mark Mark;
   typedef YAML::anchor_t anchor_t;
@@ -17,12 +17,12 @@ class NullEventHandler : public YAML::EventHandler {
   virtual void OnDocumentEnd() {}
   virtual void OnNull(const Mark&, anchor_t) {}
   virtual void OnAlias(const Mark&, anchor_t) {}
-  virtual void OnScalar(const Mark&, const std::string&, anchor_t,
-                        std::string) {}
-  virtual void OnSequenceStart(const Mark&, const std::string&, anchor_t,
+  virtual void OnScalar(const Mark&, YAML::StringView, anchor_t,
+                        YAML::StringView) {}
+  virtual void OnSequenceStart(const Mark&, YAML::StringView, anchor_t,
                                YAML::EmitterStyle::value style) {}
   virtual void OnSequenceEnd() {}
-  virtual void OnMapStart(const Mark&, const std::string&, anchor_t,
+  virtual void OnMapStart(const Mark&, YAML::StringView, anchor_t,
                           YAML::EmitterStyle::value style) {}
   virtual void OnMapEnd() {}
 };
@@ -8,4 +8,5 @@ Description: A YAML parser and emitter for C++
 Version: @YAML_CPP_VERSION@
 Requires:
 Libs: -L${libdir} -lyaml-cpp
+Libs.private: @CMAKE_THREAD_LIBS_INIT@
 Cflags: -I${includedir}